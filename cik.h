@@ -28,6 +28,15 @@ LICENSE
 
 #define CIK_API static
 
+/* If we are on a platform that does not use SSE we undefine CIK_USE_SSE if accidently enabled by the user */
+#if defined(CIK_USE_SSE) && !(defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#undef CIK_USE_SSE
+#endif
+
+#ifdef CIK_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 #ifndef CIK_MAX_JOINTS
 #define CIK_MAX_JOINTS 128
 #endif
@@ -37,6 +46,26 @@ LICENSE
 #define CIK_PI_HALF 1.57079632679489661923f
 #define CIK_PI_QUARTER 0.7853981633974483f
 
+/* Math precision tier, define one of them before including cik.h:
+ *
+ * CIK_MATH_FAST     (default) 256 entry sine table, rational atan2, one Newton step for 1/sqrt
+ * CIK_MATH_BALANCED degree 7 sine and degree 11 atan minimax polynomials, two Newton steps
+ * CIK_MATH_PRECISE  degree 9 sine and degree 15 atan minimax polynomials, three Newton steps
+ *
+ * With CIK_USE_SSE the hardware 1/sqrt estimate gets one Newton step (two for CIK_MATH_PRECISE).
+ * tests/cik_bench.c prints the error and cost of every tier.
+ */
+#if defined(CIK_MATH_PRECISE)
+#define CIK_INVSQRT_STEPS 3
+#define CIK_INVSQRT_STEPS_SSE 2
+#elif defined(CIK_MATH_BALANCED)
+#define CIK_INVSQRT_STEPS 2
+#define CIK_INVSQRT_STEPS_SSE 1
+#else
+#define CIK_INVSQRT_STEPS 1
+#define CIK_INVSQRT_STEPS_SSE 1
+#endif
+
 #ifndef VM_H
 typedef struct v3
 {
@@ -47,44 +76,135 @@ typedef struct v3
 } v3;
 #endif
 
-#ifdef __GNUC__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wstrict-aliasing"
-#pragma GCC diagnostic ignored "-Wuninitialized"
-#elif defined(_MSC_VER)
-#pragma warning(push)
-#pragma warning(disable : 4699) /* MSVC-specific aliasing warning */
-#endif
-CIK_API CIK_INLINE float cik_invsqrt(float number)
+/* 32 bit integer for reading the bits of a float, the array size fails to compile otherwise */
+typedef int cik_int32;
+typedef char cik_int32_size_check[(sizeof(cik_int32) == 4 && sizeof(float) == 4) ? 1 : -1];
+
+/* Float to bits and back through a union. Both members have the same size so every bit is
+ * written (well defined since C99 and supported by GCC, Clang and MSVC in C89).
+ */
+CIK_API CIK_INLINE cik_int32 cik_float_bits(float f)
+{
+  union
+  {
+    float f;
+    cik_int32 i;
+  } conv;
+
+  conv.f = f;
+
+  return conv.i;
+}
+
+CIK_API CIK_INLINE float cik_bits_float(cik_int32 i)
 {
   union
   {
     float f;
-    long i;
+    cik_int32 i;
   } conv;
 
-  float x2, y;
-  const float threehalfs = 1.5F;
+  conv.i = i;
+
+  return conv.f;
+}
+
+/* Software 1 / sqrt(number) for number > 0: the bit level estimate followed by Newton steps.
+ * Maximum relative error: 3.5e-2 without a step, 1.8e-3 after one, 4.7e-6 after two and
+ * float rounding (about 2e-7) after three. Only float and integer arithmetic without branches,
+ * so loops over it vectorize.
+ */
+CIK_API CIK_INLINE float cik_invsqrt_soft(float number, int steps)
+{
+  float x2 = number * 0.5f;
+  float y = cik_bits_float(0x5f3759df - (cik_float_bits(number) >> 1)); /* Magic number for approximation */
 
-  x2 = number * 0.5F;
-  conv.f = number;
-  conv.i = 0x5f3759df - (conv.i >> 1); /* Magic number for approximation */
-  y = conv.f;
-  y = y * (threehalfs - (x2 * y * y)); /* One iteration of Newton's method */
+  for (; steps > 0; --steps)
+  {
+    y = y * (1.5f - (x2 * y * y)); /* Newton's method */
+  }
 
-  return (y);
+  return y;
 }
-#ifdef __GNUC__
-#pragma GCC diagnostic pop
-#elif defined(_MSC_VER)
-#pragma warning(pop)
+
+/* 1 / sqrt(number) with the given number of Newton steps, cik_invsqrt uses the tier's count */
+CIK_API CIK_INLINE float cik_invsqrt_steps(float number, int steps)
+{
+#ifdef CIK_USE_SSE
+  /* Hardware estimate (12 bit, relative error 3.7e-4) refined by Newton steps, 1.9e-7 after
+   * one. The input is kept away from zero so that cik_sqrtf(0) stays 0 instead of 0 * inf.
+   */
+  __m128 n = _mm_max_ss(_mm_set_ss(number), _mm_set_ss(1e-30f));
+  __m128 y = _mm_rsqrt_ss(n);
+
+  for (; steps > 0; --steps)
+  {
+    __m128 yy = _mm_mul_ss(y, y);
+    y = _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), y), _mm_sub_ss(_mm_set_ss(3.0f), _mm_mul_ss(n, yy)));
+  }
+
+  return _mm_cvtss_f32(y);
+#else
+  return cik_invsqrt_soft(number, steps);
+#endif
+}
+
+CIK_API CIK_INLINE float cik_invsqrt(float number)
+{
+#ifdef CIK_USE_SSE
+  return cik_invsqrt_steps(number, CIK_INVSQRT_STEPS_SSE);
+#else
+  return cik_invsqrt_steps(number, CIK_INVSQRT_STEPS);
+#endif
+}
+
+/* out[i] = cik_invsqrt(in[i]) for count values with identical results. With CIK_USE_SSE four
+ * values share one _mm_rsqrt_ps, without it the loop over cik_invsqrt_soft vectorizes.
+ */
+CIK_API CIK_INLINE void cik_invsqrt_lanes(const float *in, float *out, int count)
+{
+  int i = 0;
+
+#ifdef CIK_USE_SSE
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 n = _mm_max_ps(_mm_loadu_ps(in + i), _mm_set1_ps(1e-30f));
+    __m128 y = _mm_rsqrt_ps(n);
+    int steps;
+
+    for (steps = 0; steps < CIK_INVSQRT_STEPS_SSE; ++steps)
+    {
+      __m128 yy = _mm_mul_ps(y, y);
+      y = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), y), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(n, yy)));
+    }
+
+    _mm_storeu_ps(out + i, y);
+  }
+
+  for (; i < count; ++i)
+  {
+    out[i] = cik_invsqrt(in[i]);
+  }
+#else
+  for (; i < count; ++i)
+  {
+    out[i] = cik_invsqrt_soft(in[i], CIK_INVSQRT_STEPS);
+  }
 #endif
+}
 
 CIK_API CIK_INLINE float cik_sqrtf(float x)
 {
   return (x * cik_invsqrt(x));
 }
 
+/* cik_sqrtf refined by one Heron step (relative error below 1e-5) */
+CIK_API CIK_INLINE float cik_sqrtf_refined(float x)
+{
+  float s = cik_sqrtf(x);
+  return (s > 1e-18f) ? 0.5f * (s + x / s) : 0.0f;
+}
+
 #define CIK_LUT_SIZE 256
 #define CIK_LUT_MASK (CIK_LUT_SIZE - 1)
 
@@ -122,7 +242,8 @@ static const float cik_lut[CIK_LUT_SIZE] = {
     -0.3827f, -0.3599f, -0.3369f, -0.3137f, -0.2903f, -0.2667f, -0.2430f, -0.2191f,
     -0.1951f, -0.1710f, -0.1467f, -0.1224f, -0.0980f, -0.0736f, -0.0491f, -0.0245f};
 
-CIK_API CIK_INLINE float cik_sinf(float x)
+/* Table sine, absolute error about 1e-4 */
+CIK_API CIK_INLINE float cik_sinf_lut(float x)
 {
   float index, frac;
   int i, i2;
@@ -144,12 +265,66 @@ CIK_API CIK_INLINE float cik_sinf(float x)
   return (cik_lut[i] + frac * (cik_lut[i2] - cik_lut[i]));
 }
 
+/* Reduces x to r in [-pi/2, pi/2] with sin(x) = sign * sin(r). pi is split in two parts
+ * (Cody-Waite), k * 3.140625f is exact for |k| < 2^16.
+ */
+CIK_API CIK_INLINE float cik_sinf_reduce(float x, float *sign)
+{
+  int k = (int)(x * (1.0f / CIK_PI) + (x < 0.0f ? -0.5f : 0.5f));
+
+  *sign = (k % 2) ? -1.0f : 1.0f;
+
+  return (x - (float)k * 3.140625f) - (float)k * 9.67653589793e-4f;
+}
+
+/* Degree 7 minimax sine, absolute error below 2e-6 */
+CIK_API CIK_INLINE float cik_sinf_minimax7(float x)
+{
+  float sign, r = cik_sinf_reduce(x, &sign), r2 = r * r;
+
+  return sign * r * (0.999999619f + r2 * (-0.166658469f + r2 * (0.00831395868f + r2 * -0.000185232202f)));
+}
+
+/* Degree 9 minimax sine, absolute error below 2e-7 (float rounding) */
+CIK_API CIK_INLINE float cik_sinf_minimax9(float x)
+{
+  float sign, r = cik_sinf_reduce(x, &sign), r2 = r * r;
+
+  return sign * r * (0.999999999f + r2 * (-0.166666625f + r2 * (0.00833313078f + r2 * (-0.000198134239f + r2 * 2.61253804e-06f))));
+}
+
+CIK_API CIK_INLINE float cik_sinf(float x)
+{
+#if defined(CIK_MATH_PRECISE)
+  return cik_sinf_minimax9(x);
+#elif defined(CIK_MATH_BALANCED)
+  return cik_sinf_minimax7(x);
+#else
+  return cik_sinf_lut(x);
+#endif
+}
+
 CIK_API CIK_INLINE float cik_cosf(float x)
 {
   return (cik_sinf(x + CIK_PI_HALF));
 }
 
-CIK_API CIK_INLINE float cik_atan2f(float y, float x)
+/* sin and cos accurate to below 1e-6 in every tier. Meant for values computed once such as
+ * the constraint tables.
+ */
+CIK_API CIK_INLINE void cik_sincosf_precise(float x, float *s, float *c)
+{
+  *s = cik_sinf_minimax9(x);
+  *c = cik_sinf_minimax9(x + CIK_PI_HALF);
+}
+
+CIK_API CIK_INLINE float cik_fabsf(float x)
+{
+  return x < 0.0f ? -x : x;
+}
+
+/* Rational atan2, absolute error up to 0.07 */
+CIK_API CIK_INLINE float cik_atan2f_rational(float y, float x)
 {
   float abs_y = (y < 0) ? -y : y;
   float angle, r;
@@ -172,9 +347,50 @@ CIK_API CIK_INLINE float cik_atan2f(float y, float x)
   return (y < 0) ? -angle : angle;
 }
 
-CIK_API CIK_INLINE float cik_fabsf(float x)
+/* atan2 folded onto atan(a) with a in [0, 1] */
+CIK_API CIK_INLINE float cik_atan2f_fold(float y, float x)
 {
-  return x < 0.0f ? -x : x;
+  float abs_x = cik_fabsf(x), abs_y = cik_fabsf(y);
+
+  return (abs_x >= abs_y) ? abs_y / (abs_x + 1e-30f) : abs_x / abs_y;
+}
+
+/* Turns p = atan(cik_atan2f_fold(y, x)) back into atan2(y, x) */
+CIK_API CIK_INLINE float cik_atan2f_unfold(float y, float x, float p)
+{
+  p = (cik_fabsf(x) >= cik_fabsf(y)) ? p : CIK_PI_HALF - p;
+  p = (x < 0.0f) ? CIK_PI - p : p;
+
+  return (y < 0.0f) ? -p : p;
+}
+
+/* Degree 11 minimax atan2, absolute error about 1e-5 */
+CIK_API CIK_INLINE float cik_atan2f_minimax11(float y, float x)
+{
+  float a = cik_atan2f_fold(y, x), a2 = a * a;
+  float p = a * (0.999999567f + a2 * (-0.333226094f + a2 * (0.197536896f + a2 * (-0.126400046f + a2 * (0.0630594549f + a2 * -0.0155716141f)))));
+
+  return cik_atan2f_unfold(y, x, p);
+}
+
+/* Degree 15 minimax atan2, absolute error below 1e-6 */
+CIK_API CIK_INLINE float cik_atan2f_minimax15(float y, float x)
+{
+  float a = cik_atan2f_fold(y, x), a2 = a * a;
+  float p = a * (0.999999999f + a2 * (-0.333332345f + a2 * (0.199937751f + a2 * (-0.141833102f + a2 * (0.104225401f + a2 * (-0.0673393121f + a2 * (0.0301469628f + a2 * -0.00640718966f)))))));
+
+  return cik_atan2f_unfold(y, x, p);
+}
+
+CIK_API CIK_INLINE float cik_atan2f(float y, float x)
+{
+#if defined(CIK_MATH_PRECISE)
+  return cik_atan2f_minimax15(y, x);
+#elif defined(CIK_MATH_BALANCED)
+  return cik_atan2f_minimax11(y, x);
+#else
+  return cik_atan2f_rational(y, x);
+#endif
 }
 
 CIK_API CIK_INLINE v3 cik_v3(float x, float y, float z)
@@ -226,8 +442,61 @@ CIK_API CIK_INLINE float cik_v3_length(v3 a)
   return cik_sqrtf(cik_v3_length_2(a));
 }
 
+#ifdef CIK_USE_SSE
+/* ---------------------- SSE Kernels ---------------------- */
+/* v3 is kept in the lower three lanes, the w lane is always zero */
+CIK_API CIK_INLINE __m128 cik_sse_load(v3 a)
+{
+  return _mm_set_ps(0.0f, a.z, a.y, a.x);
+}
+
+CIK_API CIK_INLINE v3 cik_sse_store(__m128 a)
+{
+  float r[4];
+  _mm_storeu_ps(r, a);
+  return cik_v3(r[0], r[1], r[2]);
+}
+
+/* Dot product broadcast to all lanes */
+CIK_API CIK_INLINE __m128 cik_sse_dot(__m128 a, __m128 b)
+{
+  __m128 m = _mm_mul_ps(a, b);
+  m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+CIK_API CIK_INLINE __m128 cik_sse_cross(__m128 a, __m128 b)
+{
+  __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+  return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+/* Reciprocal length broadcast to all lanes, zero for vectors shorter than 1e-9 */
+CIK_API CIK_INLINE __m128 cik_sse_inv_length(__m128 a)
+{
+  __m128 l2 = cik_sse_dot(a, a);
+  __m128 y = _mm_rsqrt_ps(l2);
+  __m128 valid = _mm_cmpgt_ps(l2, _mm_set1_ps(1e-18f));
+
+  /* One Newton step: y = 0.5 * y * (3 - l2 * y * y) */
+  y = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), y), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(l2, _mm_mul_ps(y, y))));
+
+  return _mm_and_ps(y, valid);
+}
+
+CIK_API CIK_INLINE __m128 cik_sse_normalize(__m128 a)
+{
+  return _mm_mul_ps(a, cik_sse_inv_length(a));
+}
+#endif /* CIK_USE_SSE */
+
 CIK_API CIK_INLINE v3 cik_v3_normalize(v3 a)
 {
+#ifdef CIK_USE_SSE
+  return cik_sse_store(cik_sse_normalize(cik_sse_load(a)));
+#else
   float l = cik_v3_length(a);
   v3 zero = {0, 0, 0};
 
@@ -238,274 +507,275 @@ CIK_API CIK_INLINE v3 cik_v3_normalize(v3 a)
   }
 
   return zero;
+#endif
 }
 
-/* ---------------------- Constraint Enforcers ---------------------- */
-
-/* Spherical cone constraint */
-CIK_API CIK_INLINE void cik_fabrik_enforce_spherical_cone(
-    v3 parent,
-    v3 *child,
-    v3 rest_dir,
-    float max_angle)
+/* Normalizes with cik_sqrtf_refined, zero for vectors shorter than 1e-9 */
+CIK_API CIK_INLINE v3 cik_v3_normalize_refined(v3 a)
 {
-  v3 dir = cik_v3_normalize(cik_v3_sub(*child, parent));
-  float cosang = cik_v3_dot(rest_dir, dir);
-  float cosmax = cik_cosf(max_angle);
-
-  if (cosang < cosmax)
-  {
-    /* Clamp to cone */
-    v3 axis = cik_v3_normalize(cik_v3_cross(rest_dir, dir));
-    v3 ortho = cik_v3_normalize(cik_v3_cross(axis, rest_dir));
-
-    float c = cosmax;
-    float s = cik_sinf(max_angle);
-    v3 newdir;
-
-    float d;
+  float l = cik_sqrtf_refined(cik_v3_length_2(a));
+  v3 zero = {0, 0, 0};
 
-    newdir.x = rest_dir.x * c + ortho.x * s;
-    newdir.y = rest_dir.y * c + ortho.y * s;
-    newdir.z = rest_dir.z * c + ortho.z * s;
+  return (l > 1e-9f) ? cik_v3_scale(a, 1.0f / l) : zero;
+}
 
-    d = cik_v3_length(cik_v3_sub(*child, parent));
+/* Any unit vector perpendicular to the unit vector a */
+CIK_API CIK_INLINE v3 cik_v3_perpendicular(v3 a)
+{
+  v3 up = {0.0f, 1.0f, 0.0f};
 
-    *child = cik_v3_add(parent, cik_v3_scale(newdir, d));
+  if (cik_fabsf(cik_v3_dot(a, up)) > 0.99f)
+  {
+    up.x = 1.0f;
+    up.y = 0.0f;
   }
+
+  return cik_v3_normalize_refined(cik_v3_cross(a, up));
 }
 
-/* Hinge joint constraint */
-/* ---------------------- Correct Hinge Enforcement ---------------------- */
-/* parent       = position of parent joint
- * child        = pointer to child joint position
- * axis         = hinge axis (unit vector)
- * min_angle    = min angle in radians relative to rest_dir
- * max_angle    = max angle in radians relative to rest_dir
- * rest_dir     = rest direction of the bone (normalized)
+/* Places "p" at distance "len" from "anchor" along the direction anchor -> p.
+ * This is the bone reposition step of both FABRIK passes (sub, normalize, scale, add).
  */
-CIK_API CIK_INLINE void cik_fabrik_enforce_hinge(
-    v3 parent,
-    v3 *child,
-    v3 axis,
-    float min_angle,
-    float max_angle,
-    v3 rest_dir)
+CIK_API CIK_INLINE v3 cik_v3_reposition(v3 anchor, v3 p, float len)
 {
-  v3 bone = cik_v3_sub(*child, parent);
-  float len = cik_v3_length(bone);
-  v3 dir;
-  float dot_ax;
-  v3 proj;
-  float proj_len;
-  v3 rest_proj;
-  float cos_ang;
-  float sin_ang;
-  float angle;
+#ifdef CIK_USE_SSE
+  __m128 a = cik_sse_load(anchor);
+  __m128 d = _mm_sub_ps(cik_sse_load(p), a);
+  __m128 dir = _mm_mul_ps(d, cik_sse_inv_length(d));
+  return cik_sse_store(_mm_add_ps(a, _mm_mul_ps(dir, _mm_set1_ps(len))));
+#else
+  v3 dir = cik_v3_normalize(cik_v3_sub(p, anchor));
+  return cik_v3_add(anchor, cik_v3_scale(dir, len));
+#endif
+}
 
-  if (len < 1e-8f)
-  {
-    return;
-  }
+/* ---------------------- Constraint Tables ---------------------- */
+/* A constraint compiled once per bone, so enforcing it needs no trigonometry: the limit
+ * directions are stored as cos/sin pairs (computed with cik_sincosf_precise) and hinges keep
+ * an orthonormal basis of their plane. Hinge angles are measured from rest towards side.
+ */
+typedef struct cik_constraint
+{
+  v3 rest;     /* unit rest direction, for hinges projected into the hinge plane */
+  v3 side;     /* hinge: axis x rest, rest and side span the hinge plane */
+  float cos_a; /* spherical: cos(max_angle), hinge: cos(hinge_min) */
+  float sin_a; /* spherical: sin(max_angle), hinge: sin(hinge_min) */
+  float cos_b; /* hinge: cos(hinge_max) */
+  float sin_b; /* hinge: sin(hinge_max) */
+  float range; /* hinge: hinge_max - hinge_min */
 
-  /* Normalize bone */
-  dir = cik_v3_scale(bone, 1.0f / len);
+} cik_constraint;
 
-  /* Project bone onto hinge plane */
-  dot_ax = cik_v3_dot(dir, axis);
-  proj = cik_v3_sub(dir, cik_v3_scale(axis, dot_ax));
-  proj_len = cik_v3_length(proj);
+#define CIK_CONSTRAINT_FLOATS 13
 
-  /* If projection is degenerate, the bone is aligned with the hinge axis. */
-  /* We will use the rest_dir to define its orientation on the plane. */
-  if (proj_len < 1e-8f)
+CIK_API CIK_INLINE void cik_constraint_compile(
+    cik_constraint *c,
+    v3 rest_dir,     /* normalized rest direction of the bone */
+    int hinge_type,  /* 0 = spherical, 1 = hinge */
+    float max_angle, /* spherical limit */
+    v3 hinge_axis,   /* hinge axis (unit vector) */
+    float hinge_min, /* hinge min angle */
+    float hinge_max  /* hinge max angle */
+)
+{
+  if (hinge_type)
   {
-    proj = cik_v3_sub(rest_dir, cik_v3_scale(axis, cik_v3_dot(rest_dir, axis)));
+    v3 r = cik_v3_sub(rest_dir, cik_v3_scale(hinge_axis, cik_v3_dot(rest_dir, hinge_axis)));
 
-    /* Check if rest_dir is also aligned with the hinge axis.
-     * If so, we must generate an arbitrary valid direction on the hinge plane.
-     */
-    if (cik_v3_length_2(proj) < 1e-8f)
-    {
-      v3 up = {0.0f, 1.0f, 0.0f};
-      /* If axis is aligned with 'up', use a different vector for the cross product */
-      if (cik_fabsf(cik_v3_dot(axis, up)) > 0.99f)
-      {
-        up.x = 1.0f;
-        up.y = 0.0f;
-        up.z = 0.0f;
-      }
-      proj = cik_v3_normalize(cik_v3_cross(axis, up));
-    }
-    else
-    {
-      proj = cik_v3_normalize(proj);
-    }
+    /* A rest direction along the axis gets an arbitrary direction in the plane */
+    c->rest = (cik_v3_length_2(r) < 1e-8f) ? cik_v3_perpendicular(hinge_axis) : cik_v3_normalize_refined(r);
+    c->side = cik_v3_cross(hinge_axis, c->rest);
+    cik_sincosf_precise(hinge_min, &c->sin_a, &c->cos_a);
+    cik_sincosf_precise(hinge_max, &c->sin_b, &c->cos_b);
+    c->range = hinge_max - hinge_min;
   }
   else
   {
-    proj = cik_v3_scale(proj, 1.0f / proj_len);
+    c->rest = rest_dir;
+    c->side = cik_v3(0.0f, 0.0f, 0.0f);
+    cik_sincosf_precise(max_angle, &c->sin_a, &c->cos_a);
+    c->cos_b = c->cos_a;
+    c->sin_b = c->sin_a;
+    c->range = 0.0f;
   }
+}
 
-  /* Compute angle relative to rest_dir in hinge plane */
-  rest_proj = cik_v3_sub(rest_dir, cik_v3_scale(axis, cik_v3_dot(rest_dir, axis)));
+/* Returns 1 if the unit direction (x, y) in the hinge plane lies within the limits, with
+ * slack as the allowed sine of the angle outside a limit.
+ */
+CIK_API CIK_INLINE int cik_constraint_hinge_inside(const cik_constraint *c, float x, float y, float slack)
+{
+  float after_a = c->cos_a * y - c->sin_a * x;
+  float before_b = x * c->sin_b - y * c->cos_b;
 
-  /* Apply the same robust fallback for the rest_proj calculation */
-  if (cik_v3_length_2(rest_proj) < 1e-8f)
+  /* The range runs counterclockwise from a to b */
+  if (c->range >= CIK_PI_DOUBLED)
   {
-    v3 up = {0.0f, 1.0f, 0.0f};
-    if (cik_fabsf(cik_v3_dot(axis, up)) > 0.99f)
-    {
-      up.x = 1.0f;
-      up.y = 0.0f;
-      up.z = 0.0f;
-    }
-    rest_proj = cik_v3_normalize(cik_v3_cross(axis, up));
+    return 1;
   }
-  else
+
+  if (c->range <= CIK_PI)
   {
-    rest_proj = cik_v3_normalize(rest_proj);
+    return after_a >= -slack && before_b >= -slack;
   }
 
-  cos_ang = cik_v3_dot(rest_proj, proj);
-  sin_ang = cik_v3_dot(cik_v3_cross(rest_proj, proj), axis);
-  angle = cik_atan2f(sin_ang, cos_ang);
+  return after_a >= -slack || before_b >= -slack;
+}
 
-  /* Clamp to min/max */
-  if (angle < min_angle)
-  {
-    angle = min_angle;
-  }
+/* Moves the in plane direction (x, y) (not normalized) to the unit direction within the
+ * limits that is closest to it. Returns 1 inside the limits, 2 if clamped and 0 for a
+ * degenerate direction (x and y are left untouched).
+ */
+CIK_API CIK_INLINE int cik_constraint_hinge_clamp(const cik_constraint *c, float *x, float *y)
+{
+  float w = cik_sqrtf_refined(*x * *x + *y * *y);
+  int use_a;
 
-  if (angle > max_angle)
+  if (w < 1e-8f)
   {
-    angle = max_angle;
+    return 0;
   }
 
-  /* Rotate rest_proj by clamped angle around axis */
-  {
-    float cos_theta = cik_cosf(angle);
-    float sin_theta = cik_sinf(angle);
+  *x /= w;
+  *y /= w;
 
-    v3 cross = cik_v3_cross(axis, rest_proj);
+  if (cik_constraint_hinge_inside(c, *x, *y, 0.0f))
+  {
+    return 1;
+  }
 
-    v3 new_dir;
-    /* Simplified Rodrigues' formula because axis and rest_proj are orthogonal */
-    new_dir.x = rest_proj.x * cos_theta + cross.x * sin_theta;
-    new_dir.y = rest_proj.y * cos_theta + cross.y * sin_theta;
-    new_dir.z = rest_proj.z * cos_theta + cross.z * sin_theta;
+  /* Outside the limits the closer limit direction is the best reachable one */
+  use_a = c->cos_a * *x + c->sin_a * *y >= c->cos_b * *x + c->sin_b * *y;
+  *x = use_a ? c->cos_a : c->cos_b;
+  *y = use_a ? c->sin_a : c->sin_b;
 
-    *child = cik_v3_add(parent, cik_v3_scale(new_dir, len));
-  }
+  return 2;
 }
 
-/* ---------------------- FABRIK Solver ---------------------- */
-/* 0 = converged within tolerance
- * 1 = max_iter reached (did not converge)
- * 2 = invalid input (n < 2 or exceeds CIK_MAX_JOINTS or degenerate lengths)
- * 3 = target unreachable, clamped at max reach
- */
-CIK_API CIK_INLINE int cik_fabrik_solve(
-    v3 *pos,          /* [n] joint positions (in/out) */
-    int n,            /* number of joints */
-    v3 target,        /* target position */
-    float *max_angle, /* spherical limits [n-1] */
-    int *hinge_type,  /* 0 = spherical, 1 = hinge */
-    v3 *hinge_axis,   /* hinge axes */
-    float *hinge_min, /* hinge min angles */
-    float *hinge_max, /* hinge max angles */
-    float tolerance,
-    int max_iter)
+/* Spherical cone constraint, returns 1 if the bone was clamped */
+CIK_API CIK_INLINE int cik_constraint_enforce_cone(const cik_constraint *c, v3 parent, v3 *child)
 {
-  float lengths[CIK_MAX_JOINTS];
-  v3 rest_dirs[CIK_MAX_JOINTS];
-  v3 root = pos[0];
-  float total_len = 0.0f;
-  int i, iter;
-
-  v3 root_to_target;
-  float dist2;
+#ifdef CIK_USE_SSE
+  __m128 p = cik_sse_load(parent);
+  __m128 rest = cik_sse_load(c->rest);
+  __m128 bone = _mm_sub_ps(cik_sse_load(*child), p);
+  __m128 inv = cik_sse_inv_length(bone);
+  __m128 dir = _mm_mul_ps(bone, inv);
+  __m128 cosang = cik_sse_dot(rest, dir);
 
-  if (n < 2 || n > CIK_MAX_JOINTS)
+  if (_mm_cvtss_f32(cosang) < c->cos_a)
   {
-    return 2;
+    /* Clamp to the cone in the plane of rest and dir */
+    __m128 ortho = _mm_sub_ps(dir, _mm_mul_ps(rest, cosang));
+    __m128 newdir;
+
+    ortho = (_mm_cvtss_f32(cik_sse_dot(ortho, ortho)) > 1e-12f) ? cik_sse_normalize(ortho) : cik_sse_load(cik_v3_perpendicular(c->rest));
+    newdir = _mm_add_ps(_mm_mul_ps(rest, _mm_set1_ps(c->cos_a)), _mm_mul_ps(ortho, _mm_set1_ps(c->sin_a)));
+
+    /* Bone length as l2 * rsqrt(l2), same as cik_sqrtf */
+    *child = cik_sse_store(_mm_add_ps(p, _mm_mul_ps(newdir, _mm_mul_ps(cik_sse_dot(bone, bone), inv))));
+
+    return 1;
   }
+#else
+  v3 bone = cik_v3_sub(*child, parent);
+  v3 dir = cik_v3_normalize(bone);
+  float cosang = cik_v3_dot(c->rest, dir);
 
-  /* Precompute lengths and rest dirs */
-  for (i = 0; i < n - 1; i++)
+  if (cosang < c->cos_a)
   {
-    v3 diff = cik_v3_sub(pos[i + 1], pos[i]);
-    lengths[i] = cik_v3_length(diff);
+    /* Clamp to the cone in the plane of rest and dir */
+    v3 ortho = cik_v3_sub(dir, cik_v3_scale(c->rest, cosang));
+    v3 newdir;
 
-    if (lengths[i] < 1e-10f)
-    {
-      return 2;
-    }
+    ortho = (cik_v3_length_2(ortho) > 1e-12f) ? cik_v3_normalize(ortho) : cik_v3_perpendicular(c->rest);
+    newdir = cik_v3_add(cik_v3_scale(c->rest, c->cos_a), cik_v3_scale(ortho, c->sin_a));
 
-    total_len += lengths[i];
-    rest_dirs[i] = cik_v3_normalize(diff);
+    *child = cik_v3_add(parent, cik_v3_scale(newdir, cik_v3_length(bone)));
+
+    return 1;
   }
+#endif
 
-  /* Check reachability */
-  root_to_target = cik_v3_sub(target, root);
-  dist2 = cik_v3_length_2(root_to_target);
+  return 0;
+}
+
+/* Hinge constraint, moves the bone into the hinge plane and returns 1 if the angle was
+ * clamped to the limits. A bone along the axis turns to the rest direction.
+ */
+CIK_API CIK_INLINE int cik_constraint_enforce_hinge(const cik_constraint *c, v3 parent, v3 *child)
+{
+  v3 bone = cik_v3_sub(*child, parent);
+  float len = cik_v3_length(bone);
+  float x, y;
+  int result;
 
-  if (dist2 > total_len * total_len)
+  if (len < 1e-8f)
   {
-    /* Target is unreachable — stretch arm toward it */
-    v3 dir = cik_v3_normalize(root_to_target);
+    return 0;
+  }
 
-    for (i = 1; i < n; ++i)
-    {
-      pos[i] = cik_v3_add(pos[i - 1], cik_v3_scale(dir, lengths[i - 1]));
-    }
+  x = cik_v3_dot(bone, c->rest);
+  y = cik_v3_dot(bone, c->side);
+  result = cik_constraint_hinge_clamp(c, &x, &y);
 
-    return 3;
+  if (result == 0)
+  {
+    x = 1.0f;
+    y = 0.0f;
+    result = cik_constraint_hinge_clamp(c, &x, &y);
   }
 
-  /* Iteration loop */
-  for (iter = 0; iter < max_iter; ++iter)
-  {
-    v3 diff;
+  *child = cik_v3_add(parent, cik_v3_scale(cik_v3_add(cik_v3_scale(c->rest, x), cik_v3_scale(c->side, y)), len));
 
-    /* Forward reaching */
-    pos[n - 1] = target;
+  return result == 2;
+}
 
-    for (i = n - 2; i >= 0; --i)
-    {
-      v3 dir = cik_v3_normalize(cik_v3_sub(pos[i], pos[i + 1]));
-      pos[i] = cik_v3_add(pos[i + 1], cik_v3_scale(dir, lengths[i]));
-    }
+CIK_API CIK_INLINE int cik_constraint_enforce(const cik_constraint *c, int hinge_type, v3 parent, v3 *child)
+{
+  return hinge_type ? cik_constraint_enforce_hinge(c, parent, child) : cik_constraint_enforce_cone(c, parent, child);
+}
 
-    /* Backward reaching */
-    pos[0] = root;
+/* ---------------------- Constraint Enforcers ---------------------- */
+/* Single call versions that compile the constraint on every call, solvers keep compiled tables */
 
-    for (i = 0; i < n - 1; ++i)
-    {
-      v3 dir = cik_v3_normalize(cik_v3_sub(pos[i + 1], pos[i]));
-      pos[i + 1] = cik_v3_add(pos[i], cik_v3_scale(dir, lengths[i]));
+/* Spherical cone constraint, returns 1 if the bone was clamped */
+CIK_API CIK_INLINE int cik_fabrik_enforce_spherical_cone(
+    v3 parent,
+    v3 *child,
+    v3 rest_dir,
+    float max_angle)
+{
+  cik_constraint c;
 
-      /* Apply constraints */
-      if (hinge_type[i] == 0)
-      {
-        cik_fabrik_enforce_spherical_cone(pos[i], &pos[i + 1], rest_dirs[i], max_angle[i]);
-      }
-      else
-      {
-        cik_fabrik_enforce_hinge(pos[i], &pos[i + 1], hinge_axis[i], hinge_min[i], hinge_max[i], rest_dirs[i]);
-      }
-    }
+  cik_constraint_compile(&c, rest_dir, 0, max_angle, rest_dir, 0.0f, 0.0f);
 
-    /* Check convergence */
-    diff = cik_v3_sub(pos[n - 1], target);
+  return cik_constraint_enforce_cone(&c, parent, child);
+}
 
-    if (cik_v3_length_2(diff) <= tolerance * tolerance)
-    {
-      return 0;
-    }
-  }
+/* Hinge joint constraint
+ * parent       = position of parent joint
+ * child        = pointer to child joint position
+ * axis         = hinge axis (unit vector)
+ * min_angle    = min angle in radians relative to rest_dir
+ * max_angle    = max angle in radians relative to rest_dir
+ * rest_dir     = rest direction of the bone (normalized)
+ *
+ * Returns 1 if the angle was clamped to the limits.
+ */
+CIK_API CIK_INLINE int cik_fabrik_enforce_hinge(
+    v3 parent,
+    v3 *child,
+    v3 axis,
+    float min_angle,
+    float max_angle,
+    v3 rest_dir)
+{
+  cik_constraint c;
 
-  return 1;
+  cik_constraint_compile(&c, rest_dir, 1, 0.0f, axis, min_angle, max_angle);
+
+  return cik_constraint_enforce_hinge(&c, parent, child);
 }
 
 /*
@@ -532,6 +802,3848 @@ CIK_API CIK_INLINE float cik_calculate_hinge_angle(v3 bone_parent_pos, v3 bone_c
   return cik_atan2f(sin_ang, cos_ang);
 }
 
+/* ---------------------- FABRIK Chain ---------------------- */
+/* A chain captures everything cik_fabrik_solve derives from the joint positions once:
+ * the bone lengths, the total and squared reach and the rest direction of every bone.
+ * The rest frame stays fixed across solves so the constraints are always measured
+ * against the pose the chain was initialized with and not against the last solved pose.
+ *
+ * All per bone data lives in caller provided scratch memory of cik_fabrik_scratch_size(n)
+ * bytes, so a chain has no joint limit and no stack cost. The scratch memory must stay
+ * valid while the chain is used.
+ *
+ * The constraint arrays are referenced, not copied. cik_chain_init compiles them into
+ * constraint tables, call cik_chain_compile after changing them between solves.
+ */
+
+/* Floats of scratch memory needed for n joints: lengths, rest dirs, the planar solver workspace
+ * and the constraint tables
+ */
+#define CIK_FABRIK_SCRATCH_FLOATS(n) ((15 + CIK_CONSTRAINT_FLOATS) * ((n) - 1))
+
+CIK_API CIK_INLINE unsigned long cik_fabrik_scratch_size(int n)
+{
+  return n < 2 ? 0 : (unsigned long)CIK_FABRIK_SCRATCH_FLOATS(n) * (unsigned long)sizeof(float);
+}
+
+typedef struct cik_chain
+{
+  int n;             /* number of joints */
+  float *lengths;    /* [n-1] bone lengths */
+  v3 *rest_dirs;     /* [n-1] normalized rest direction per bone */
+  float *work;       /* [11 * (n-1)] solver workspace (planar, CCD, DLS and FABRIK momentum) */
+  float total_len;   /* maximum reach */
+  float total_len_2; /* squared maximum reach */
+  float inner_len;   /* minimum reach: longest bone minus all others, 0 if they fold back over it */
+  int flags;         /* CIK_FABRIK_* solver options, 0 after cik_chain_init */
+
+  v3 last_target;       /* target, root and end effector of the last settled solve (CIK_FABRIK_SKIP_IDLE) */
+  v3 last_root;
+  v3 last_end;
+  float last_tolerance; /* tolerance of the last settled solve */
+  int last_result;      /* result of the last settled solve, -1 = none */
+
+  cik_constraint *constraints; /* [n-1] compiled constraint arrays */
+
+  float *max_angle; /* spherical limits [n-1] */
+  int *hinge_type;  /* 0 = spherical, 1 = hinge */
+  v3 *hinge_axis;   /* hinge axes */
+  float *hinge_min; /* hinge min angles */
+  float *hinge_max; /* hinge max angles */
+
+} cik_chain;
+
+/* Compiles the constraint arrays into the chain's constraint tables. The last settled solve
+ * is forgotten, it was found under the old constraints.
+ */
+CIK_API CIK_INLINE void cik_chain_compile(cik_chain *chain)
+{
+  int i;
+
+  chain->last_result = -1;
+
+  for (i = 0; i < chain->n - 1; ++i)
+  {
+    if (chain->hinge_type[i])
+    {
+      cik_constraint_compile(&chain->constraints[i], chain->rest_dirs[i], 1, 0.0f, chain->hinge_axis[i], chain->hinge_min[i], chain->hinge_max[i]);
+    }
+    else
+    {
+      cik_constraint_compile(&chain->constraints[i], chain->rest_dirs[i], 0, chain->max_angle[i], chain->rest_dirs[i], 0.0f, 0.0f);
+    }
+  }
+}
+
+/* 0 = initialized
+ * 2 = invalid input (n < 2, no scratch memory or degenerate lengths)
+ */
+CIK_API CIK_INLINE int cik_chain_init(
+    cik_chain *chain,
+    void *scratch,    /* cik_fabrik_scratch_size(n) bytes, aligned for float */
+    v3 *pos,          /* [n] joint positions in rest pose */
+    int n,            /* number of joints */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max  /* hinge max angles */
+)
+{
+  int i;
+
+  if (n < 2 || !scratch)
+  {
+    return 2;
+  }
+
+  chain->n = n;
+  chain->lengths = (float *)scratch;
+  chain->rest_dirs = (v3 *)(chain->lengths + (n - 1));
+  chain->work = (float *)(chain->rest_dirs + (n - 1));
+  chain->constraints = (cik_constraint *)(chain->work + 11 * (n - 1));
+  chain->total_len = 0.0f;
+  chain->flags = 0;
+  chain->last_result = -1;
+  chain->max_angle = max_angle;
+  chain->hinge_type = hinge_type;
+  chain->hinge_axis = hinge_axis;
+  chain->hinge_min = hinge_min;
+  chain->hinge_max = hinge_max;
+
+  /* Precompute lengths and rest dirs */
+  for (i = 0; i < n - 1; i++)
+  {
+    v3 diff = cik_v3_sub(pos[i + 1], pos[i]);
+    chain->lengths[i] = cik_v3_length(diff);
+
+    if (chain->lengths[i] < 1e-10f)
+    {
+      return 2;
+    }
+
+    chain->total_len += chain->lengths[i];
+    chain->rest_dirs[i] = cik_v3_normalize(diff);
+  }
+
+  chain->total_len_2 = chain->total_len * chain->total_len;
+  chain->inner_len = 0.0f;
+
+  for (i = 0; i < n - 1; i++)
+  {
+    float inner = 2.0f * chain->lengths[i] - chain->total_len;
+    chain->inner_len = inner > chain->inner_len ? inner : chain->inner_len;
+  }
+
+  cik_chain_compile(chain);
+
+  return 0;
+}
+
+/* ---------------------- Two Bone Solver ---------------------- */
+/* Tolerance used when checking a closed-form pose against the joint constraints */
+#ifndef CIK_CONSTRAINT_EPSILON
+#define CIK_CONSTRAINT_EPSILON 1e-3f
+#endif
+
+/* Returns 1 if bone i (parent -> child) satisfies its constraint, using the same angle
+ * measurement as the enforcers.
+ */
+CIK_API CIK_INLINE int cik_chain_bone_valid(cik_chain *chain, int i, v3 parent, v3 child)
+{
+  cik_constraint *c = &chain->constraints[i];
+  v3 dir = cik_v3_normalize(cik_v3_sub(child, parent));
+
+  if (chain->hinge_type[i] == 0)
+  {
+    return cik_v3_dot(c->rest, dir) >= c->cos_a - CIK_CONSTRAINT_EPSILON;
+  }
+
+  if (cik_fabsf(cik_v3_dot(dir, chain->hinge_axis[i])) > CIK_CONSTRAINT_EPSILON)
+  {
+    return 0;
+  }
+
+  return cik_constraint_hinge_inside(c, cik_v3_dot(dir, c->rest), cik_v3_dot(dir, c->side), CIK_CONSTRAINT_EPSILON);
+}
+
+/* Stretches the chain from its root toward an unreachable target */
+CIK_API CIK_INLINE void cik_chain_stretch(cik_chain *chain, v3 *pos, v3 target)
+{
+  v3 dir = cik_v3_normalize(cik_v3_sub(target, pos[0]));
+  int i;
+
+  for (i = 1; i < chain->n; ++i)
+  {
+    pos[i] = cik_v3_add(pos[i - 1], cik_v3_scale(dir, chain->lengths[i - 1]));
+  }
+}
+
+/* Closed-form (law of cosines) solver for an initialized 3 joint chain.
+ *
+ * The elbow lies on the circle of points at distance lengths[0] from the root and
+ * lengths[1] from the target. Two candidates on that circle are built:
+ * - elbow hinge:  the two points where bone 1 lies in the hinge plane
+ * - root hinge:   the two points in the root hinge plane
+ * - otherwise:    the two points in the plane through root, target and pole
+ * The candidate closer to the pole that satisfies every constraint is used. The bones keep
+ * the lengths recorded in the chain and the end effector is placed exactly on the target.
+ *
+ * 0 = target reached, pos updated
+ * 1 = no exact solution satisfies the constraints or the target is inside the minimum reach (pos untouched)
+ * 2 = invalid input (chain has not 3 joints)
+ * 3 = target unreachable, clamped at max reach
+ */
+CIK_API CIK_INLINE int cik_chain_solve_two_bone(
+    cik_chain *chain,
+    v3 *pos,   /* [3] joint positions (in/out) */
+    v3 target, /* target position */
+    v3 pole    /* position the elbow should bend toward */
+)
+{
+  float a, b, d, cos_a, radius;
+  v3 root, u, center, e1, e2;
+  v3 candidates[2];
+  int i;
+
+  if (chain->n != 3)
+  {
+    return 2;
+  }
+
+  root = pos[0];
+  a = chain->lengths[0];
+  b = chain->lengths[1];
+  d = cik_sqrtf_refined(cik_v3_length_2(cik_v3_sub(target, root)));
+
+  if (d * d > chain->total_len_2)
+  {
+    cik_chain_stretch(chain, pos, target);
+    return 3;
+  }
+
+  if (d < cik_fabsf(a - b) || d < 1e-9f)
+  {
+    return 1;
+  }
+
+  /* Circle of possible elbow positions */
+  u = cik_v3_scale(cik_v3_sub(target, root), 1.0f / d);
+  cos_a = (a * a + d * d - b * b) / (2.0f * a * d);
+  cos_a = cos_a > 1.0f ? 1.0f : (cos_a < -1.0f ? -1.0f : cos_a);
+  center = cik_v3_add(root, cik_v3_scale(u, a * cos_a));
+  radius = a * cik_sqrtf_refined(1.0f - cos_a * cos_a);
+
+  if (chain->hinge_type[1] != 0)
+  {
+    /* Bone 1 must be perpendicular to the elbow hinge axis h: (elbow - target) . h = 0 */
+    v3 h = chain->hinge_axis[1];
+    v3 h_plane = cik_v3_sub(h, cik_v3_scale(u, cik_v3_dot(h, u)));
+    float r = cik_sqrtf_refined(cik_v3_length_2(h_plane));
+    float k = cik_v3_dot(cik_v3_sub(target, center), h);
+
+    if (r * radius < 1e-9f)
+    {
+      /* Hinge axis along root -> target, every point of the circle works if any does */
+      if (cik_fabsf(k) > CIK_CONSTRAINT_EPSILON)
+      {
+        return 1;
+      }
+
+      e1 = cik_v3_sub(pole, center);
+      e1 = cik_v3_sub(e1, cik_v3_scale(u, cik_v3_dot(e1, u)));
+      e1 = cik_v3_length_2(e1) > 1e-12f ? cik_v3_normalize_refined(e1) : cik_v3_perpendicular(u);
+
+      candidates[0] = cik_v3_add(center, cik_v3_scale(e1, radius));
+      candidates[1] = cik_v3_sub(center, cik_v3_scale(e1, radius));
+    }
+    else
+    {
+      float cos_phi = k / (r * radius);
+      float sin_phi;
+
+      if (cos_phi > 1.0f + CIK_CONSTRAINT_EPSILON || cos_phi < -1.0f - CIK_CONSTRAINT_EPSILON)
+      {
+        return 1;
+      }
+
+      cos_phi = cos_phi > 1.0f ? 1.0f : (cos_phi < -1.0f ? -1.0f : cos_phi);
+      sin_phi = cik_sqrtf_refined(1.0f - cos_phi * cos_phi);
+      e1 = cik_v3_scale(h_plane, 1.0f / r);
+      e2 = cik_v3_cross(u, e1);
+
+      candidates[0] = cik_v3_add(center, cik_v3_scale(cik_v3_add(cik_v3_scale(e1, cos_phi), cik_v3_scale(e2, sin_phi)), radius));
+      candidates[1] = cik_v3_add(center, cik_v3_scale(cik_v3_sub(cik_v3_scale(e1, cos_phi), cik_v3_scale(e2, sin_phi)), radius));
+    }
+  }
+  else
+  {
+    if (chain->hinge_type[0] != 0 && cik_fabsf(cik_v3_dot(u, chain->hinge_axis[0])) < CIK_CONSTRAINT_EPSILON)
+    {
+      /* Bend inside the root hinge plane */
+      e1 = cik_v3_normalize_refined(cik_v3_cross(chain->hinge_axis[0], u));
+    }
+    else
+    {
+      /* Bend toward the pole */
+      e1 = cik_v3_sub(pole, center);
+      e1 = cik_v3_sub(e1, cik_v3_scale(u, cik_v3_dot(e1, u)));
+      e1 = cik_v3_length_2(e1) > 1e-12f ? cik_v3_normalize_refined(e1) : cik_v3_perpendicular(u);
+    }
+
+    candidates[0] = cik_v3_add(center, cik_v3_scale(e1, radius));
+    candidates[1] = cik_v3_sub(center, cik_v3_scale(e1, radius));
+  }
+
+  /* Prefer the candidate on the pole side */
+  if (cik_v3_dot(cik_v3_sub(candidates[1], candidates[0]), cik_v3_sub(pole, center)) > 0.0f)
+  {
+    v3 tmp = candidates[0];
+    candidates[0] = candidates[1];
+    candidates[1] = tmp;
+  }
+
+  for (i = 0; i < 2; ++i)
+  {
+    if (cik_chain_bone_valid(chain, 0, root, candidates[i]) && cik_chain_bone_valid(chain, 1, candidates[i], target))
+    {
+      pos[1] = candidates[i];
+      pos[2] = target;
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* Closed-form solver for a 3 joint chain in its current pose (rest directions are taken from
+ * the current positions like in cik_fabrik_solve). The constraint arrays have 2 entries.
+ *
+ * 0 = target reached, pos updated
+ * 1 = no exact solution satisfies the constraints or the target is inside the minimum reach (pos untouched)
+ * 2 = invalid input (degenerate lengths)
+ * 3 = target unreachable, clamped at max reach
+ */
+CIK_API CIK_INLINE int cik_solve_two_bone(
+    v3 *pos,          /* [3] joint positions (in/out) */
+    v3 target,        /* target position */
+    v3 pole,          /* position the elbow should bend toward */
+    float *max_angle, /* spherical limits [2] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max  /* hinge max angles */
+)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(3)];
+
+  if (cik_chain_init(&chain, scratch, pos, 3, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve_two_bone(&chain, pos, target, pole);
+}
+
+/* ---------------------- Solve Info ---------------------- */
+/* Optional statistics filled by the *_ex solvers. Set trajectory/trajectory_capacity before
+ * the solve to record the end effector error after every iteration, the other fields are
+ * overwritten. Passing a null info pointer skips all bookkeeping.
+ */
+typedef struct cik_solve_info
+{
+  int iterations;          /* iterations run (the closed-form two bone pass counts as 1) */
+  float error;             /* final distance from the end effector to the target */
+  float *trajectory;       /* [trajectory_capacity] error per iteration (optional, may be 0) */
+  int trajectory_capacity; /* entries available in trajectory */
+  int trajectory_count;    /* entries written to trajectory */
+  int cone_active;         /* number of times a cone constraint clamped a bone */
+  int hinge_active;        /* number of times a hinge constraint clamped a bone */
+  int jacobian_builds;     /* DLS only: Jacobians built, the other iterations reused a cached one */
+  int stalled;             /* FABRIK only: 1 if the solve stopped because the error stopped decreasing */
+
+} cik_solve_info;
+
+CIK_API CIK_INLINE void cik_solve_info_begin(cik_solve_info *info)
+{
+  info->iterations = 0;
+  info->error = 0.0f;
+  info->trajectory_count = 0;
+  info->cone_active = 0;
+  info->hinge_active = 0;
+  info->jacobian_builds = 0;
+  info->stalled = 0;
+}
+
+/* Records one iteration ending with the squared end effector error err_2 */
+CIK_API CIK_INLINE void cik_solve_info_iteration(cik_solve_info *info, float err_2)
+{
+  info->iterations++;
+
+  if (info->trajectory && info->trajectory_count < info->trajectory_capacity)
+  {
+    info->trajectory[info->trajectory_count++] = cik_sqrtf(err_2);
+  }
+}
+
+CIK_API CIK_INLINE void cik_solve_info_end(cik_solve_info *info, v3 end_effector, v3 target)
+{
+  info->error = cik_sqrtf(cik_v3_length_2(cik_v3_sub(end_effector, target)));
+}
+
+/* ---------------------- Planar Hinge Solver ---------------------- */
+/* Returns 1 if every bone is a hinge and all hinge axes are parallel (or antiparallel), so
+ * the chain can only move in the plane through the root perpendicular to that axis.
+ */
+CIK_API CIK_INLINE int cik_chain_is_planar(cik_chain *chain)
+{
+  v3 axis = chain->hinge_axis[0];
+  int i;
+
+  for (i = 0; i < chain->n - 1; ++i)
+  {
+    if (chain->hinge_type[i] == 0 || cik_fabsf(cik_v3_dot(chain->hinge_axis[i], axis)) < 1.0f - 1e-4f)
+    {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* Plane of a planar chain solve: basis (e1, e2) of the hinge plane through the root and the
+ * target in that basis. The per bone state lives in chain->work, 6 arrays of n-1 floats:
+ * bone direction (ux, uy), rest direction (rx, ry) and rest direction rotated by +90 degrees
+ * around the bone's axis (sx, sy). The sweeps work on the cosine and sine of the hinge angle
+ * (the direction in the rest frame), the angle itself is only measured when it is stored.
+ */
+typedef struct cik_planar_frame
+{
+  v3 e1;       /* first basis vector of the hinge plane */
+  v3 e2;       /* second basis vector, axis x e1 */
+  float tx;    /* target in the plane, relative to the root */
+  float ty;    /* target in the plane, relative to the root */
+  float off_2; /* squared distance of the target from the plane */
+
+} cik_planar_frame;
+
+/* Sets up the plane, rest frames (from the constraint tables) and the current bone
+ * directions of a planar chain.
+ */
+CIK_API CIK_INLINE void cik_chain_planar_setup(cik_chain *chain, v3 *pos, v3 target, cik_planar_frame *frame)
+{
+  int m = chain->n - 1;
+  float *ux = chain->work, *uy = ux + m;
+  float *rx = uy + m, *ry = rx + m;
+  float *sx = ry + m, *sy = sx + m;
+  v3 axis = chain->hinge_axis[0];
+  v3 to_target = cik_v3_sub(target, pos[0]);
+  float off;
+  int i;
+
+  frame->e1 = cik_v3_perpendicular(axis);
+  frame->e2 = cik_v3_cross(axis, frame->e1);
+  frame->tx = cik_v3_dot(to_target, frame->e1);
+  frame->ty = cik_v3_dot(to_target, frame->e2);
+  off = cik_v3_dot(to_target, axis);
+  frame->off_2 = off * off;
+
+  /* Rest frame per bone, angles measured like cik_calculate_hinge_angle */
+  for (i = 0; i < m; ++i)
+  {
+    cik_constraint *c = &chain->constraints[i];
+
+    rx[i] = cik_v3_dot(c->rest, frame->e1);
+    ry[i] = cik_v3_dot(c->rest, frame->e2);
+    sx[i] = cik_v3_dot(c->side, frame->e1);
+    sy[i] = cik_v3_dot(c->side, frame->e2);
+
+    /* Start from the current pose */
+    {
+      v3 bone = cik_v3_sub(pos[i + 1], pos[i]);
+      float bx = cik_v3_dot(bone, frame->e1);
+      float by = cik_v3_dot(bone, frame->e2);
+      float l = cik_sqrtf_refined(bx * bx + by * by);
+
+      ux[i] = (l > 1e-8f) ? bx / l : rx[i];
+      uy[i] = (l > 1e-8f) ? by / l : ry[i];
+    }
+  }
+}
+
+/* One sweep over all bones (tip to root), returns the squared end effector error */
+CIK_API CIK_INLINE float cik_chain_planar_sweep(cik_chain *chain, cik_planar_frame *frame, cik_solve_info *info)
+{
+  int m = chain->n - 1;
+  float *ux = chain->work, *uy = ux + m;
+  float *rx = uy + m, *ry = rx + m;
+  float *sx = ry + m, *sy = sx + m;
+  float ex = 0.0f, ey = 0.0f;
+  float dx, dy;
+  int i;
+
+  for (i = 0; i < m; ++i)
+  {
+    ex += chain->lengths[i] * ux[i];
+    ey += chain->lengths[i] * uy[i];
+  }
+
+  for (i = m - 1; i >= 0; --i)
+  {
+    float len = chain->lengths[i];
+    float wx = frame->tx - ex + len * ux[i];
+    float wy = frame->ty - ey + len * uy[i];
+    float x = rx[i] * wx + ry[i] * wy;
+    float y = sx[i] * wx + sy[i] * wy;
+    float nx, ny;
+    int result = cik_constraint_hinge_clamp(&chain->constraints[i], &x, &y);
+
+    if (result == 0)
+    {
+      continue;
+    }
+
+    /* Outside the limits the closer limit direction is the best reachable one */
+    if (result == 2 && info)
+    {
+      info->hinge_active++;
+    }
+
+    nx = rx[i] * x + sx[i] * y;
+    ny = ry[i] * x + sy[i] * y;
+    ex += len * (nx - ux[i]);
+    ey += len * (ny - uy[i]);
+    ux[i] = nx;
+    uy[i] = ny;
+  }
+
+  dx = frame->tx - ex;
+  dy = frame->ty - ey;
+
+  return dx * dx + dy * dy + frame->off_2;
+}
+
+/* Writes the bone directions back as joint positions in the plane through pos[0] and
+ * measures the hinge angles if angles is given
+ */
+CIK_API CIK_INLINE void cik_chain_planar_store(cik_chain *chain, v3 *pos, cik_planar_frame *frame, float *angles)
+{
+  int m = chain->n - 1;
+  float *ux = chain->work, *uy = ux + m;
+  float *rx = uy + m, *ry = rx + m;
+  float *sx = ry + m, *sy = sx + m;
+  int i;
+
+  for (i = 0; i < m; ++i)
+  {
+    v3 dir = cik_v3_add(cik_v3_scale(frame->e1, ux[i]), cik_v3_scale(frame->e2, uy[i]));
+    pos[i + 1] = cik_v3_add(pos[i], cik_v3_scale(dir, chain->lengths[i]));
+
+    if (angles)
+    {
+      angles[i] = cik_atan2f_minimax15(sx[i] * ux[i] + sy[i] * uy[i], rx[i] * ux[i] + ry[i] * uy[i]);
+    }
+  }
+}
+
+/* Solves a planar hinge chain (see cik_chain_is_planar) in 2D joint-angle space.
+ *
+ * Every hinge angle is measured against the bone's rest direction, so the bone directions
+ * are independent of each other. Each sweep moves one bone at a time (tip to root) to the
+ * direction that brings the end effector closest to the target. That direction is the
+ * normalized vector from the rest of the chain to the target or, if it falls outside the
+ * limits, the closer limit direction. The range test and clamp are the ones of the
+ * constraint tables, so a hinge never leaves its limits. No rotation is needed per bone.
+ *
+ * The target is projected onto the hinge plane, an out-of-plane offset counts toward the
+ * tolerance. The solved bones lie in the hinge plane through pos[0].
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached (did not converge)
+ * 2 = invalid input (chain is not planar)
+ * 3 = target unreachable, clamped at max reach
+ */
+CIK_API CIK_INLINE int cik_chain_solve_planar_ex(
+    cik_chain *chain,
+    v3 *pos,             /* [n] joint positions (in/out) */
+    v3 target,           /* target position */
+    float tolerance,     /* tolerance */
+    int max_iter,        /* max iterations */
+    float *angles,       /* [n-1] solved hinge angles (optional, may be 0) */
+    cik_solve_info *info /* statistics (optional, may be 0), a clamped bone counts as hinge activity */
+)
+{
+  cik_planar_frame frame;
+  int iter, code = 1;
+
+  if (info)
+  {
+    cik_solve_info_begin(info);
+  }
+
+  if (!cik_chain_is_planar(chain))
+  {
+    return 2;
+  }
+
+  if (cik_v3_length_2(cik_v3_sub(target, pos[0])) > chain->total_len_2)
+  {
+    cik_chain_stretch(chain, pos, target);
+    code = 3;
+  }
+  else
+  {
+    cik_chain_planar_setup(chain, pos, target, &frame);
+
+    for (iter = 0; iter < max_iter; ++iter)
+    {
+      float err_2 = cik_chain_planar_sweep(chain, &frame, info);
+
+      if (info)
+      {
+        cik_solve_info_iteration(info, err_2);
+      }
+
+      if (err_2 <= tolerance * tolerance)
+      {
+        code = 0;
+        break;
+      }
+    }
+
+    cik_chain_planar_store(chain, pos, &frame, angles);
+  }
+
+  if (info)
+  {
+    cik_solve_info_end(info, pos[chain->n - 1], target);
+  }
+
+  return code;
+}
+
+CIK_API CIK_INLINE int cik_chain_solve_planar(
+    cik_chain *chain,
+    v3 *pos,         /* [n] joint positions (in/out) */
+    v3 target,       /* target position */
+    float tolerance, /* tolerance */
+    int max_iter,    /* max iterations */
+    float *angles    /* [n-1] solved hinge angles (optional, may be 0) */
+)
+{
+  return cik_chain_solve_planar_ex(chain, pos, target, tolerance, max_iter, angles, 0);
+}
+
+/* ---------------------- FABRIK Solver ---------------------- */
+/* Stall detection: an iteration that does not bring the error below CIK_FABRIK_STALL_RATIO
+ * times the previous error makes no progress. After CIK_FABRIK_STALL_SWEEPS of them in a row
+ * the solve stops with return code 1 (targets behind a limit stop after a few iterations
+ * instead of max_iter). 0 sweeps disables the check.
+ */
+#ifndef CIK_FABRIK_STALL_RATIO
+#define CIK_FABRIK_STALL_RATIO 0.999f
+#endif
+
+#ifndef CIK_FABRIK_STALL_SWEEPS
+#define CIK_FABRIK_STALL_SWEEPS 3
+#endif
+
+/* Solver options, combined in cik_chain.flags.
+ *
+ * CIK_FABRIK_MOMENTUM: before every sweep the joints are pushed further along their last
+ * step (by CIK_FABRIK_MOMENTUM_BETA), so a correction at the tip reaches the root in fewer
+ * sweeps on long constrained chains. A sweep that ends with a larger error is undone and run
+ * again without momentum. Short or unconstrained chains converge as fast without it, planar
+ * hinge chains ignore it.
+ *
+ * CIK_FABRIK_CONSTRAIN_FORWARD: the forward pass (tip to root) enforces the constraints too,
+ * so it no longer folds joints into poses the backward pass has to pull back out of. The
+ * reversed bone is checked against the reflected rest frame by mirroring it through its
+ * child joint, which reuses the compiled tables. Planar hinge chains ignore it, their
+ * joint-angle solve never leaves the limits.
+ *
+ * CIK_FABRIK_SKIP_IDLE: the chain remembers its last settled solve (converged, unreachable
+ * or inside the minimum reach). While target, root and end effector all stay within
+ * CIK_FABRIK_IDLE_EPSILON of it and the result still holds at the new tolerance (see
+ * cik_fabrik_settled_holds), the next solve returns the same result without touching the
+ * pose or running a sweep. Solves that stalled or ran out of max_iter are not settled, calling
+ * again keeps improving them, so max_iter never changes a settled result. cik_chain_compile
+ * forgets the settled solve.
+ */
+#define CIK_FABRIK_MOMENTUM 1
+#define CIK_FABRIK_CONSTRAIN_FORWARD 2
+#define CIK_FABRIK_SKIP_IDLE 4
+
+#ifndef CIK_FABRIK_IDLE_EPSILON
+#define CIK_FABRIK_IDLE_EPSILON 1e-5f
+#endif
+
+#ifndef CIK_FABRIK_MOMENTUM_BETA
+#define CIK_FABRIK_MOMENTUM_BETA 1.0f
+#endif
+
+/* Returns 1 if the squared error err_2 is no progress over prev_2 */
+CIK_API CIK_INLINE int cik_fabrik_no_progress(float err_2, float prev_2)
+{
+  return err_2 > prev_2 * (CIK_FABRIK_STALL_RATIO * CIK_FABRIK_STALL_RATIO);
+}
+
+/* Returns 1 if a result settled at settled_tolerance still holds at tolerance. A converged
+ * pose meets every looser tolerance, a target inside the minimum reach stays inside for every
+ * tighter one (the check shrinks the reach by the tolerance), reachability ignores it.
+ */
+CIK_API CIK_INLINE int cik_fabrik_settled_holds(int result, float settled_tolerance, float tolerance)
+{
+  if (result == 0)
+  {
+    return tolerance >= settled_tolerance;
+  }
+
+  if (result == 4)
+  {
+    return tolerance <= settled_tolerance;
+  }
+
+  return result > 0;
+}
+
+/* Returns 1 if root, target and end effector are where the last settled solve left them and
+ * its result holds at tolerance
+ */
+CIK_API CIK_INLINE int cik_chain_idle(cik_chain *chain, v3 root, v3 target, v3 end, float tolerance)
+{
+  float epsilon_2 = CIK_FABRIK_IDLE_EPSILON * CIK_FABRIK_IDLE_EPSILON;
+
+  return cik_fabrik_settled_holds(chain->last_result, chain->last_tolerance, tolerance) &&
+         cik_v3_length_2(cik_v3_sub(target, chain->last_target)) <= epsilon_2 &&
+         cik_v3_length_2(cik_v3_sub(root, chain->last_root)) <= epsilon_2 &&
+         cik_v3_length_2(cik_v3_sub(end, chain->last_end)) <= epsilon_2;
+}
+
+/* Returns 1 if the target lies inside the chain's minimum reach, so no pose reaches it */
+CIK_API CIK_INLINE int cik_chain_inside_inner_reach(cik_chain *chain, v3 root, v3 target, float tolerance)
+{
+  float inner = chain->inner_len - tolerance;
+
+  return inner > 0.0f && cik_v3_length_2(cik_v3_sub(target, root)) < inner * inner;
+}
+
+/* One forward and backward reaching pass with constraints (on the backward pass, on both
+ * with CIK_FABRIK_CONSTRAIN_FORWARD), the root is pinned to root. Returns the squared
+ * distance from the end effector to the target.
+ */
+CIK_API CIK_INLINE float cik_chain_sweep(
+    cik_chain *chain,
+    v3 *pos,   /* [n] joint positions (in/out) */
+    v3 target, /* target position */
+    v3 root,   /* root position */
+    cik_solve_info *info /* constraint activity (optional, may be 0) */
+)
+{
+  int n = chain->n;
+  float *lengths = chain->lengths;
+  cik_constraint *constraints = chain->constraints;
+  int forward = (chain->flags & CIK_FABRIK_CONSTRAIN_FORWARD) != 0;
+  int i;
+
+  /* Forward reaching */
+  pos[n - 1] = target;
+
+  for (i = n - 2; i >= 0; --i)
+  {
+    pos[i] = cik_v3_reposition(pos[i + 1], pos[i], lengths[i]);
+
+    if (forward)
+    {
+      /* pos[i] mirrored through pos[i + 1] gives the bone in its own direction */
+      v3 mirror = cik_v3_sub(cik_v3_scale(pos[i + 1], 2.0f), pos[i]);
+      int clamped = cik_constraint_enforce(&constraints[i], chain->hinge_type[i], pos[i + 1], &mirror);
+
+      pos[i] = cik_v3_sub(cik_v3_scale(pos[i + 1], 2.0f), mirror);
+
+      if (info)
+      {
+        info->cone_active += chain->hinge_type[i] ? 0 : clamped;
+        info->hinge_active += chain->hinge_type[i] ? clamped : 0;
+      }
+    }
+  }
+
+  /* Backward reaching */
+  pos[0] = root;
+
+  for (i = 0; i < n - 1; ++i)
+  {
+    pos[i + 1] = cik_v3_reposition(pos[i], pos[i + 1], lengths[i]);
+
+    /* Apply constraints */
+    if (chain->hinge_type[i] == 0)
+    {
+      int clamped = cik_constraint_enforce_cone(&constraints[i], pos[i], &pos[i + 1]);
+
+      if (info)
+      {
+        info->cone_active += clamped;
+      }
+    }
+    else
+    {
+      int clamped = cik_constraint_enforce_hinge(&constraints[i], pos[i], &pos[i + 1]);
+
+      if (info)
+      {
+        info->hinge_active += clamped;
+      }
+    }
+  }
+
+  return cik_v3_length_2(cik_v3_sub(pos[n - 1], target));
+}
+
+/* Resumable solve of an initialized chain: cik_fabrik_begin sets up the solve,
+ * cik_fabrik_step runs one iteration (a forward and backward pass, or one planar sweep)
+ * and cik_fabrik_end returns the result code. The joint positions are valid after every
+ * step, so a solve can be paused between steps and spread across frames. The state holds
+ * no memory of its own, only one solve may run per chain at a time (planar chains keep
+ * their solver state in the chain's scratch memory).
+ */
+typedef struct cik_fabrik_state
+{
+  cik_chain *chain;       /* chain being solved */
+  v3 *pos;                /* [n] joint positions (in/out) */
+  v3 target;              /* target position */
+  v3 root;                /* pinned root position */
+  float tolerance;        /* tolerance */
+  int max_iter;           /* max iterations */
+  int iterations;         /* iterations run so far */
+  float error_2;          /* squared end effector error after the last step */
+  int stalls;             /* consecutive iterations without progress */
+  int flags;              /* CIK_FABRIK_* options, taken from the chain */
+  int momentum;           /* 1 if chain->work holds the pose before the last accepted step */
+  int result;             /* result code, 1 while running */
+  int done;               /* 1 once converged, max_iter reached or solved without iterating */
+  int planar;             /* 1 if the chain is solved in joint-angle space */
+  cik_planar_frame frame; /* plane of the planar solve */
+  cik_solve_info *info;   /* statistics (optional, may be 0) */
+
+} cik_fabrik_state;
+
+/* Remembers a finished solve for CIK_FABRIK_SKIP_IDLE, result 1 is not settled */
+CIK_API CIK_INLINE void cik_fabrik_settle(cik_fabrik_state *state)
+{
+  cik_chain *chain = state->chain;
+
+  chain->last_target = state->target;
+  chain->last_root = state->root;
+  chain->last_end = state->pos[chain->n - 1];
+  chain->last_tolerance = state->tolerance;
+  chain->last_result = state->result != 1 ? state->result : -1;
+}
+
+/* Starts a solve, returns 1 if nothing is left to iterate (unreachable target, solved in
+ * closed form or idle, see cik_chain_solve_ex).
+ */
+CIK_API CIK_INLINE int cik_fabrik_begin(
+    cik_fabrik_state *state,
+    cik_chain *chain,
+    v3 *pos,   /* [n] joint positions (in/out) */
+    v3 target, /* target position */
+    float tolerance,
+    int max_iter,
+    cik_solve_info *info /* statistics (optional, may be 0) */
+)
+{
+  int n = chain->n;
+
+  state->chain = chain;
+  state->pos = pos;
+  state->target = target;
+  state->root = pos[0];
+  state->tolerance = tolerance;
+  state->max_iter = max_iter;
+  state->iterations = 0;
+  state->error_2 = cik_v3_length_2(cik_v3_sub(pos[n - 1], target));
+  state->stalls = 0;
+  state->flags = chain->flags;
+  state->momentum = 0;
+  state->result = 1;
+  state->done = max_iter <= 0;
+  state->planar = 0;
+  state->frame.e1 = state->frame.e2 = cik_v3(0.0f, 0.0f, 0.0f);
+  state->frame.tx = state->frame.ty = state->frame.off_2 = 0.0f;
+  state->info = info;
+
+  if (info)
+  {
+    cik_solve_info_begin(info);
+  }
+
+  /* Nothing moved since the last settled solve, keep its pose and result */
+  if ((state->flags & CIK_FABRIK_SKIP_IDLE) && cik_chain_idle(chain, state->root, target, pos[n - 1], tolerance))
+  {
+    state->result = chain->last_result;
+    state->done = 1;
+
+    return 1;
+  }
+
+  chain->last_result = -1;
+
+  /* Check reachability */
+  if (cik_v3_length_2(cik_v3_sub(target, state->root)) > chain->total_len_2)
+  {
+    /* Target is unreachable — stretch arm toward it */
+    cik_chain_stretch(chain, pos, target);
+    state->result = 3;
+    state->done = 1;
+  }
+  /* Target inside the minimum reach, the pose is left untouched */
+  else if (cik_chain_inside_inner_reach(chain, state->root, target, tolerance))
+  {
+    state->result = 4;
+    state->done = 1;
+  }
+  /* Two bones are solved in closed form, bending toward the current elbow. If the constraints
+   * reject the exact solution FABRIK takes over from the untouched pose.
+   */
+  else if (n == 3 && cik_chain_solve_two_bone(chain, pos, target, pos[1]) == 0)
+  {
+    if (info)
+    {
+      cik_solve_info_iteration(info, 0.0f);
+    }
+
+    state->iterations = 1;
+    state->error_2 = 0.0f;
+    state->result = 0;
+    state->done = 1;
+  }
+  /* Hinges sharing one axis are solved in joint-angle space */
+  else if (cik_chain_is_planar(chain))
+  {
+    cik_chain_planar_setup(chain, pos, target, &state->frame);
+    state->planar = 1;
+  }
+
+  if (state->done && (state->flags & CIK_FABRIK_SKIP_IDLE))
+  {
+    cik_fabrik_settle(state);
+  }
+
+  return state->done;
+}
+
+/* cik_chain_sweep with momentum (see CIK_FABRIK_MOMENTUM), prev_2 is the error before the
+ * sweep. chain->work holds the pose before the last accepted step.
+ */
+CIK_API CIK_INLINE float cik_chain_sweep_momentum(cik_fabrik_state *state, float prev_2)
+{
+  int n = state->chain->n;
+  v3 *pos = state->pos;
+  v3 *last = (v3 *)state->chain->work;
+  float err_2;
+  int i;
+
+  for (i = 0; i < n; ++i)
+  {
+    v3 current = pos[i];
+
+    if (state->momentum)
+    {
+      pos[i] = cik_v3_add(current, cik_v3_scale(cik_v3_sub(current, last[i]), CIK_FABRIK_MOMENTUM_BETA));
+    }
+
+    last[i] = current;
+  }
+
+  err_2 = cik_chain_sweep(state->chain, pos, state->target, state->root, state->info);
+
+  /* The error grew, redo the sweep without momentum from the pose before the step. The
+   * rejected sweep counts as an iteration, without one left the pose before the step is kept.
+   */
+  if (state->momentum && err_2 > prev_2)
+  {
+    for (i = 0; i < n; ++i)
+    {
+      pos[i] = last[i];
+    }
+
+    if (state->iterations + 1 >= state->max_iter)
+    {
+      return prev_2;
+    }
+
+    state->iterations++;
+
+    if (state->info)
+    {
+      cik_solve_info_iteration(state->info, err_2);
+    }
+
+    err_2 = cik_chain_sweep(state->chain, pos, state->target, state->root, state->info);
+  }
+
+  state->momentum = 1;
+
+  return err_2;
+}
+
+/* Runs one iteration, returns 1 once the solve is done */
+CIK_API CIK_INLINE int cik_fabrik_step(cik_fabrik_state *state)
+{
+  float prev_2 = state->error_2;
+
+  if (state->done)
+  {
+    return 1;
+  }
+
+  if (state->planar)
+  {
+    state->error_2 = cik_chain_planar_sweep(state->chain, &state->frame, state->info);
+    cik_chain_planar_store(state->chain, state->pos, &state->frame, 0);
+  }
+  else if (state->flags & CIK_FABRIK_MOMENTUM)
+  {
+    state->error_2 = cik_chain_sweep_momentum(state, prev_2);
+  }
+  else
+  {
+    state->error_2 = cik_chain_sweep(state->chain, state->pos, state->target, state->root, state->info);
+  }
+
+  state->iterations++;
+
+  if (state->info)
+  {
+    cik_solve_info_iteration(state->info, state->error_2);
+  }
+
+  if (state->error_2 <= state->tolerance * state->tolerance)
+  {
+    state->result = 0;
+    state->done = 1;
+  }
+  else if (state->iterations >= state->max_iter)
+  {
+    state->done = 1;
+  }
+  else if (CIK_FABRIK_STALL_SWEEPS > 0)
+  {
+    state->stalls = cik_fabrik_no_progress(state->error_2, prev_2) ? state->stalls + 1 : 0;
+
+    if (state->stalls >= CIK_FABRIK_STALL_SWEEPS)
+    {
+      state->done = 1;
+
+      if (state->info)
+      {
+        state->info->stalled = 1;
+      }
+    }
+  }
+
+  if (state->done && (state->flags & CIK_FABRIK_SKIP_IDLE))
+  {
+    cik_fabrik_settle(state);
+  }
+
+  return state->done;
+}
+
+/* Finishes a solve (also valid for a paused one) and returns the result code.
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached, stalled or not finished (did not converge)
+ * 3 = target unreachable, clamped at max reach
+ * 4 = target inside the minimum reach (longest bone minus the others), pose unchanged
+ */
+CIK_API CIK_INLINE int cik_fabrik_end(cik_fabrik_state *state)
+{
+  if (state->info)
+  {
+    cik_solve_info_end(state->info, state->pos[state->chain->n - 1], state->target);
+  }
+
+  return state->result;
+}
+
+/* Solves an initialized chain. pos[0] is the root and keeps its position.
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached or stalled (did not converge)
+ * 3 = target unreachable, clamped at max reach
+ * 4 = target inside the minimum reach (longest bone minus the others), pose unchanged
+ */
+CIK_API CIK_INLINE int cik_chain_solve_ex(
+    cik_chain *chain,
+    v3 *pos,   /* [n] joint positions (in/out) */
+    v3 target, /* target position */
+    float tolerance,
+    int max_iter,
+    cik_solve_info *info /* statistics (optional, may be 0) */
+)
+{
+  cik_fabrik_state state;
+
+  if (!cik_fabrik_begin(&state, chain, pos, target, tolerance, max_iter, info))
+  {
+    while (!cik_fabrik_step(&state))
+    {
+    }
+  }
+
+  return cik_fabrik_end(&state);
+}
+
+CIK_API CIK_INLINE int cik_chain_solve(
+    cik_chain *chain,
+    v3 *pos,   /* [n] joint positions (in/out) */
+    v3 target, /* target position */
+    float tolerance,
+    int max_iter)
+{
+  return cik_chain_solve_ex(chain, pos, target, tolerance, max_iter, 0);
+}
+
+/* Solves the chain in its current pose. The rest directions are taken from the current
+ * positions on every call, use cik_chain_init/cik_chain_solve to keep a fixed rest pose.
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached or stalled (did not converge)
+ * 2 = invalid input (n < 2 or exceeds CIK_MAX_JOINTS or degenerate lengths)
+ * 3 = target unreachable, clamped at max reach
+ * 4 = target inside the minimum reach (longest bone minus the others), pose unchanged
+ */
+CIK_API CIK_INLINE int cik_fabrik_solve(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+  if (n > CIK_MAX_JOINTS || cik_chain_init(&chain, scratch, pos, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve(&chain, pos, target, tolerance, max_iter);
+}
+
+/* cik_fabrik_solve that also reports iterations, final error, the optional per iteration
+ * error trajectory and constraint activity in info (see cik_solve_info).
+ */
+CIK_API CIK_INLINE int cik_fabrik_solve_ex(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter,
+    cik_solve_info *info /* statistics (optional, may be 0) */
+)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+  if (info)
+  {
+    cik_solve_info_begin(info);
+  }
+
+  if (n > CIK_MAX_JOINTS || cik_chain_init(&chain, scratch, pos, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve_ex(&chain, pos, target, tolerance, max_iter, info);
+}
+
+/* Like cik_fabrik_solve but without the CIK_MAX_JOINTS limit and its stack scratch.
+ * The scratch memory (cik_fabrik_scratch_size(n) bytes) can be reused for every solve.
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached or stalled (did not converge)
+ * 2 = invalid input (n < 2, no scratch memory or degenerate lengths)
+ * 3 = target unreachable, clamped at max reach
+ * 4 = target inside the minimum reach (longest bone minus the others), pose unchanged
+ */
+CIK_API CIK_INLINE int cik_fabrik_solve_scratch(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter,
+    void *scratch /* cik_fabrik_scratch_size(n) bytes, aligned for float */
+)
+{
+  cik_chain chain;
+
+  if (cik_chain_init(&chain, scratch, pos, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve(&chain, pos, target, tolerance, max_iter);
+}
+
+/* Like cik_fabrik_solve for chains whose bones are all hinges sharing one axis. Also
+ * returns the solved hinge angles relative to the current pose, so no separate
+ * cik_calculate_hinge_angle pass is needed.
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached (did not converge)
+ * 2 = invalid input (see cik_fabrik_solve, or the chain is not planar)
+ * 3 = target unreachable, clamped at max reach
+ */
+CIK_API CIK_INLINE int cik_fabrik_solve_planar(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    int *hinge_type,  /* 1 = hinge for every bone */
+    v3 *hinge_axis,   /* hinge axes, all parallel */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter,
+    float *angles /* [n-1] solved hinge angles (optional, may be 0) */
+)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+  if (n > CIK_MAX_JOINTS || cik_chain_init(&chain, scratch, pos, n, 0, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve_planar(&chain, pos, target, tolerance, max_iter, angles);
+}
+
+/* ---------------------- Specialized FABRIK Solvers ---------------------- */
+/* CIK_DEFINE_FABRIK_SOLVER(name, N, hinge_mask) defines a FABRIK solver for chains of exactly
+ * N joints whose bone i is a hinge if bit i of hinge_mask is set and spherical otherwise:
+ *
+ *   CIK_DEFINE_FABRIK_SOLVER(cik_solve_arm4, 4, 0x2)
+ *   code = cik_solve_arm4(&chain, pos, target, 1e-3f, 32);
+ *
+ * The passes are unrolled per bone and the constraint of every bone is picked by a constant
+ * mask bit that the compiler folds away, so a sweep has no loop and no hinge_type branch.
+ * N has to be a literal (or a macro expanding to one) from 2 to 16.
+ *
+ * The chain comes from cik_chain_init with matching hinge types. The solver runs the same
+ * operations as cik_chain_solve (reachability checks, two bone closed form, stall rule and
+ * CIK_FABRIK_CONSTRAIN_FORWARD) and returns the same codes, 2 if chain->n != N or the hinge
+ * types of the chain do not match hinge_mask (see cik_chain_hinge_mask). Planar hinge
+ * chains are iterated with FABRIK sweeps instead of the planar solve, CIK_FABRIK_MOMENTUM and
+ * CIK_FABRIK_SKIP_IDLE are ignored.
+ */
+/* Bit i set for every hinge bone i of the chain, the hinge_mask a specialized solver needs */
+CIK_API CIK_INLINE long cik_chain_hinge_mask(cik_chain *chain)
+{
+  long mask = 0;
+  int i;
+
+  for (i = 0; i < chain->n - 1; ++i)
+  {
+    mask |= (long)(chain->hinge_type[i] != 0) << i;
+  }
+
+  return mask;
+}
+
+/* CIK_UNROLL_n expands m(i, a) for the bones of an n joint chain, i = 0 .. n - 2, the
+ * reverse variants count down from n - 2 to 0
+ */
+#define CIK_UNROLL_2(m, a) m(0, a)
+#define CIK_UNROLL_3(m, a) CIK_UNROLL_2(m, a) m(1, a)
+#define CIK_UNROLL_4(m, a) CIK_UNROLL_3(m, a) m(2, a)
+#define CIK_UNROLL_5(m, a) CIK_UNROLL_4(m, a) m(3, a)
+#define CIK_UNROLL_6(m, a) CIK_UNROLL_5(m, a) m(4, a)
+#define CIK_UNROLL_7(m, a) CIK_UNROLL_6(m, a) m(5, a)
+#define CIK_UNROLL_8(m, a) CIK_UNROLL_7(m, a) m(6, a)
+#define CIK_UNROLL_9(m, a) CIK_UNROLL_8(m, a) m(7, a)
+#define CIK_UNROLL_10(m, a) CIK_UNROLL_9(m, a) m(8, a)
+#define CIK_UNROLL_11(m, a) CIK_UNROLL_10(m, a) m(9, a)
+#define CIK_UNROLL_12(m, a) CIK_UNROLL_11(m, a) m(10, a)
+#define CIK_UNROLL_13(m, a) CIK_UNROLL_12(m, a) m(11, a)
+#define CIK_UNROLL_14(m, a) CIK_UNROLL_13(m, a) m(12, a)
+#define CIK_UNROLL_15(m, a) CIK_UNROLL_14(m, a) m(13, a)
+#define CIK_UNROLL_16(m, a) CIK_UNROLL_15(m, a) m(14, a)
+
+#define CIK_UNROLL_REVERSE_2(m, a) m(0, a)
+#define CIK_UNROLL_REVERSE_3(m, a) m(1, a) CIK_UNROLL_REVERSE_2(m, a)
+#define CIK_UNROLL_REVERSE_4(m, a) m(2, a) CIK_UNROLL_REVERSE_3(m, a)
+#define CIK_UNROLL_REVERSE_5(m, a) m(3, a) CIK_UNROLL_REVERSE_4(m, a)
+#define CIK_UNROLL_REVERSE_6(m, a) m(4, a) CIK_UNROLL_REVERSE_5(m, a)
+#define CIK_UNROLL_REVERSE_7(m, a) m(5, a) CIK_UNROLL_REVERSE_6(m, a)
+#define CIK_UNROLL_REVERSE_8(m, a) m(6, a) CIK_UNROLL_REVERSE_7(m, a)
+#define CIK_UNROLL_REVERSE_9(m, a) m(7, a) CIK_UNROLL_REVERSE_8(m, a)
+#define CIK_UNROLL_REVERSE_10(m, a) m(8, a) CIK_UNROLL_REVERSE_9(m, a)
+#define CIK_UNROLL_REVERSE_11(m, a) m(9, a) CIK_UNROLL_REVERSE_10(m, a)
+#define CIK_UNROLL_REVERSE_12(m, a) m(10, a) CIK_UNROLL_REVERSE_11(m, a)
+#define CIK_UNROLL_REVERSE_13(m, a) m(11, a) CIK_UNROLL_REVERSE_12(m, a)
+#define CIK_UNROLL_REVERSE_14(m, a) m(12, a) CIK_UNROLL_REVERSE_13(m, a)
+#define CIK_UNROLL_REVERSE_15(m, a) m(13, a) CIK_UNROLL_REVERSE_14(m, a)
+#define CIK_UNROLL_REVERSE_16(m, a) m(14, a) CIK_UNROLL_REVERSE_15(m, a)
+
+#define CIK_UNROLL(count, m, a) CIK_UNROLL_EXPAND(count, m, a)
+#define CIK_UNROLL_EXPAND(count, m, a) CIK_UNROLL_##count(m, a)
+#define CIK_UNROLL_REVERSE(count, m, a) CIK_UNROLL_REVERSE_EXPAND(count, m, a)
+#define CIK_UNROLL_REVERSE_EXPAND(count, m, a) CIK_UNROLL_REVERSE_##count(m, a)
+
+#define CIK_FABRIK_UNROLL_FORWARD(i, hinge_mask)                \
+  pos[i] = cik_v3_reposition(pos[(i) + 1], pos[i], lengths[i]);
+
+#define CIK_FABRIK_UNROLL_FORWARD_CONSTRAINED(i, hinge_mask)              \
+  CIK_FABRIK_UNROLL_FORWARD(i, hinge_mask)                                \
+  mirror = cik_v3_sub(cik_v3_scale(pos[(i) + 1], 2.0f), pos[i]);          \
+  if (((hinge_mask) >> (i)) & 1)                                          \
+  {                                                                       \
+    cik_constraint_enforce_hinge(&constraints[i], pos[(i) + 1], &mirror); \
+  }                                                                       \
+  else                                                                    \
+  {                                                                       \
+    cik_constraint_enforce_cone(&constraints[i], pos[(i) + 1], &mirror);  \
+  }                                                                       \
+  pos[i] = cik_v3_sub(cik_v3_scale(pos[(i) + 1], 2.0f), mirror);
+
+#define CIK_FABRIK_UNROLL_BACKWARD(i, hinge_mask)                         \
+  pos[(i) + 1] = cik_v3_reposition(pos[i], pos[(i) + 1], lengths[i]);     \
+  if (((hinge_mask) >> (i)) & 1)                                          \
+  {                                                                       \
+    cik_constraint_enforce_hinge(&constraints[i], pos[i], &pos[(i) + 1]); \
+  }                                                                       \
+  else                                                                    \
+  {                                                                       \
+    cik_constraint_enforce_cone(&constraints[i], pos[i], &pos[(i) + 1]);  \
+  }
+
+#define CIK_DEFINE_FABRIK_SOLVER(name, N, hinge_mask)                                              \
+  CIK_API CIK_INLINE float name##_sweep(cik_chain *chain, v3 *pos, v3 target, v3 root)             \
+  {                                                                                                \
+    float *lengths = chain->lengths;                                                               \
+    cik_constraint *constraints = chain->constraints;                                              \
+    v3 mirror;                                                                                     \
+                                                                                                   \
+    pos[(N) - 1] = target;                                                                         \
+                                                                                                   \
+    if (chain->flags & CIK_FABRIK_CONSTRAIN_FORWARD)                                               \
+    {                                                                                              \
+      CIK_UNROLL_REVERSE(N, CIK_FABRIK_UNROLL_FORWARD_CONSTRAINED, hinge_mask)                     \
+    }                                                                                              \
+    else                                                                                           \
+    {                                                                                              \
+      CIK_UNROLL_REVERSE(N, CIK_FABRIK_UNROLL_FORWARD, hinge_mask)                                 \
+    }                                                                                              \
+                                                                                                   \
+    pos[0] = root;                                                                                 \
+    CIK_UNROLL(N, CIK_FABRIK_UNROLL_BACKWARD, hinge_mask)                                          \
+                                                                                                   \
+    return cik_v3_length_2(cik_v3_sub(pos[(N) - 1], target));                                      \
+  }                                                                                                \
+                                                                                                   \
+  CIK_API CIK_INLINE int name(cik_chain *chain, v3 *pos, v3 target, float tolerance, int max_iter) \
+  {                                                                                                \
+    v3 root = pos[0];                                                                              \
+    float err_2 = cik_v3_length_2(cik_v3_sub(pos[chain->n - 1], target));                          \
+    int iter, stalls = 0;                                                                          \
+                                                                                                   \
+    if (chain->n != (N) || cik_chain_hinge_mask(chain) != (long)(hinge_mask))                      \
+    {                                                                                              \
+      return 2;                                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    if (cik_v3_length_2(cik_v3_sub(target, root)) > chain->total_len_2)                            \
+    {                                                                                              \
+      cik_chain_stretch(chain, pos, target);                                                       \
+      return 3;                                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    if (cik_chain_inside_inner_reach(chain, root, target, tolerance))                              \
+    {                                                                                              \
+      return 4;                                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    if ((N) == 3 && cik_chain_solve_two_bone(chain, pos, target, pos[1]) == 0)                     \
+    {                                                                                              \
+      return 0;                                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    for (iter = 0; iter < max_iter; ++iter)                                                        \
+    {                                                                                              \
+      float prev_2 = err_2;                                                                        \
+                                                                                                   \
+      err_2 = name##_sweep(chain, pos, target, root);                                              \
+                                                                                                   \
+      if (err_2 <= tolerance * tolerance)                                                          \
+      {                                                                                            \
+        return 0;                                                                                  \
+      }                                                                                            \
+                                                                                                   \
+      stalls = cik_fabrik_no_progress(err_2, prev_2) ? stalls + 1 : 0;                             \
+                                                                                                   \
+      if (CIK_FABRIK_STALL_SWEEPS > 0 && stalls >= CIK_FABRIK_STALL_SWEEPS)                        \
+      {                                                                                            \
+        break;                                                                                     \
+      }                                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    return 1;                                                                                      \
+  }
+
+/* ---------------------- CCD Solver ---------------------- */
+/* Cyclic coordinate descent on the same chains and constraint arrays as FABRIK. The
+ * constraints are defined on the direction of every bone, so those directions are the
+ * coordinates: each step turns one bone so that the end effector, carried along by the
+ * bones after it, gets as close to the target as the bone's cone or hinge range allows.
+ *
+ * Hinges are turned in their plane, in joint-angle space, with the range test and clamp of
+ * the constraint tables, so a hinge never leaves its limits. The bone directions live in
+ * chain->work.
+ */
+CIK_API CIK_INLINE void cik_chain_ccd_setup(cik_chain *chain, v3 *pos)
+{
+  v3 *dirs = (v3 *)chain->work;
+  int i;
+
+  for (i = 0; i < chain->n - 1; ++i)
+  {
+    dirs[i] = cik_v3_normalize(cik_v3_sub(pos[i + 1], pos[i]));
+  }
+}
+
+/* Turns hinge bone i to the in plane direction (x, y) (not normalized), or to the closer
+ * limit if that direction is outside the limits. Returns 1 inside the limits, 2 if clamped
+ * and 0 for a degenerate direction (*dir is left untouched).
+ */
+CIK_API CIK_INLINE int cik_chain_hinge_clamp(cik_chain *chain, int i, float x, float y, v3 *dir, cik_solve_info *info)
+{
+  cik_constraint *c = &chain->constraints[i];
+  int result = cik_constraint_hinge_clamp(c, &x, &y);
+
+  if (result)
+  {
+    *dir = cik_v3_add(cik_v3_scale(c->rest, x), cik_v3_scale(c->side, y));
+  }
+
+  if (result == 2 && info)
+  {
+    info->hinge_active++;
+  }
+
+  return result;
+}
+
+/* One sweep from the tip to the root, the joints are rebuilt from the root once at the end.
+ * Returns the squared end effector error.
+ */
+CIK_API CIK_INLINE float cik_chain_ccd_sweep(
+    cik_chain *chain,
+    v3 *pos,   /* [n] joint positions (in/out) */
+    v3 target, /* target position */
+    cik_solve_info *info /* constraint activity (optional, may be 0) */
+)
+{
+  int n = chain->n;
+  int m = n - 1;
+  float *lengths = chain->lengths;
+  v3 *dirs = (v3 *)chain->work;
+  v3 end = pos[0];
+  int i;
+
+  for (i = 0; i < m; ++i)
+  {
+    end = cik_v3_add(end, cik_v3_scale(dirs[i], lengths[i]));
+  }
+
+  for (i = m - 1; i >= 0; --i)
+  {
+    /* Best direction for bone i with the bones after it carried along */
+    v3 want = cik_v3_add(cik_v3_sub(target, end), cik_v3_scale(dirs[i], lengths[i]));
+    v3 dir;
+
+    if (chain->hinge_type[i] == 0)
+    {
+      v3 child;
+
+      if (cik_v3_length_2(want) < 1e-18f)
+      {
+        continue;
+      }
+
+      child = cik_v3_add(pos[i], want);
+
+      if (cik_constraint_enforce_cone(&chain->constraints[i], pos[i], &child) && info)
+      {
+        info->cone_active++;
+      }
+
+      dir = cik_v3_normalize(cik_v3_sub(child, pos[i]));
+    }
+    else if (!cik_chain_hinge_clamp(chain, i, cik_v3_dot(want, chain->constraints[i].rest), cik_v3_dot(want, chain->constraints[i].side), &dir, info))
+    {
+      continue;
+    }
+
+    end = cik_v3_add(end, cik_v3_scale(cik_v3_sub(dir, dirs[i]), lengths[i]));
+    dirs[i] = dir;
+  }
+
+  for (i = 0; i < m; ++i)
+  {
+    pos[i + 1] = cik_v3_add(pos[i], cik_v3_scale(dirs[i], lengths[i]));
+  }
+
+  return cik_v3_length_2(cik_v3_sub(pos[n - 1], target));
+}
+
+/* Same return codes as cik_chain_solve. Unreachable targets keep the constraints: the chain
+ * reaches as far towards the target as they allow, sweeps stop once the error improves by
+ * less than the tolerance and the result is 3.
+ */
+CIK_API CIK_INLINE int cik_chain_solve_ccd_ex(
+    cik_chain *chain,
+    v3 *pos,   /* [n] joint positions (in/out) */
+    v3 target, /* target position */
+    float tolerance,
+    int max_iter,
+    cik_solve_info *info /* statistics (optional, may be 0) */
+)
+{
+  float tolerance_2 = tolerance * tolerance;
+  float err_2 = cik_v3_length_2(cik_v3_sub(pos[chain->n - 1], target));
+  int unreachable = cik_v3_length_2(cik_v3_sub(target, pos[0])) > chain->total_len_2;
+  int iter;
+
+  if (info)
+  {
+    cik_solve_info_begin(info);
+  }
+
+  cik_chain_ccd_setup(chain, pos);
+
+  for (iter = 0; iter < max_iter && (unreachable || err_2 > tolerance_2); ++iter)
+  {
+    float prev_2 = err_2;
+
+    err_2 = cik_chain_ccd_sweep(chain, pos, target, info);
+
+    if (info)
+    {
+      cik_solve_info_iteration(info, err_2);
+    }
+
+    if (unreachable && cik_sqrtf(prev_2) - cik_sqrtf(err_2) < tolerance)
+    {
+      break;
+    }
+  }
+
+  if (info)
+  {
+    info->error = cik_sqrtf(err_2);
+  }
+
+  return unreachable ? 3 : (err_2 <= tolerance_2 ? 0 : 1);
+}
+
+/* cik_fabrik_solve with CCD, same arguments and return codes */
+CIK_API CIK_INLINE int cik_ccd_solve(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+  if (n > CIK_MAX_JOINTS || cik_chain_init(&chain, scratch, pos, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve_ccd_ex(&chain, pos, target, tolerance, max_iter, 0);
+}
+
+/* ---------------------- DLS Solver ---------------------- */
+/* Damped least squares (Levenberg-Marquardt) on the same chains as FABRIK and CCD. Joint i
+ * turns the bones after it around pos[i], a hinge joint around its axis and a spherical joint
+ * around any axis. With the end effector error e and the lever r = end - pos[i] every step
+ * turns the joints by J^T (J J^T + d^2 I)^-1 e, where J J^T is only 3x3:
+ *
+ *   hinge joint:     c c^T with the column c = axis x r
+ *   spherical joint: |r|^2 I - r r^T (the three columns x x r, y x r, z x r)
+ *
+ * The turns add up from the root to the tip, afterwards every bone direction is projected
+ * back into its cone or hinge range like in CCD. The lever arms tell bones with the same
+ * direction apart, so a straight chain bends. A joint whose bone was clamped in the last
+ * step is left out of J until its bone leaves the limit again, so the free joints take over
+ * instead of pushing against the limit. The flags follow the bone directions in chain->work.
+ *
+ * Starting from the previous solution a small target delta converges in one or two steps.
+ * J J^T changes little between such steps, so a cik_dls_cache keeps its factorization
+ * across steps and solves until the bones turned by CIK_DLS_CACHE_MOTION radians, the error
+ * grew or the caller moved the end effector.
+ */
+#ifndef CIK_DLS_DAMPING
+#define CIK_DLS_DAMPING 0.05f /* damping d as a fraction of the chain reach */
+#endif
+
+#ifndef CIK_DLS_MAX_STEP
+#define CIK_DLS_MAX_STEP 0.25f /* largest error handled per step as a fraction of the chain reach */
+#endif
+
+#ifndef CIK_DLS_CACHE_MOTION
+#define CIK_DLS_CACHE_MOTION 0.05f
+#endif
+
+#ifndef CIK_DLS_HYBRID_RATIO
+#define CIK_DLS_HYBRID_RATIO 0.9f /* the hybrid solver leaves FABRIK once an iteration keeps more of the error */
+#endif
+
+/* Cholesky factorization of the symmetric positive definite 3x3 matrix
+ * a = {a00, a10, a11, a20, a21, a22} in place into the lower triangle in the same layout.
+ * Returns 0 if the matrix is not positive definite.
+ */
+CIK_API CIK_INLINE int cik_sym3_factor(float a[6])
+{
+  if (a[0] <= 1e-20f)
+  {
+    return 0;
+  }
+
+  a[0] = cik_sqrtf_refined(a[0]);
+  a[1] /= a[0];
+  a[2] -= a[1] * a[1];
+
+  if (a[2] <= 1e-20f)
+  {
+    return 0;
+  }
+
+  a[2] = cik_sqrtf_refined(a[2]);
+  a[3] /= a[0];
+  a[4] = (a[4] - a[3] * a[1]) / a[2];
+  a[5] -= a[3] * a[3] + a[4] * a[4];
+
+  if (a[5] <= 1e-20f)
+  {
+    return 0;
+  }
+
+  a[5] = cik_sqrtf_refined(a[5]);
+
+  return 1;
+}
+
+/* Solves L L^T x = b with the factor from cik_sym3_factor */
+CIK_API CIK_INLINE v3 cik_sym3_solve(float l[6], v3 b)
+{
+  v3 x;
+  float z0 = b.x / l[0];
+  float z1 = (b.y - l[1] * z0) / l[2];
+  float z2 = (b.z - l[3] * z0 - l[4] * z1) / l[5];
+
+  x.z = z2 / l[5];
+  x.y = (z1 - l[4] * x.z) / l[2];
+  x.x = (z0 - l[1] * x.y - l[3] * x.z) / l[0];
+
+  return x;
+}
+
+typedef struct cik_dls_cache
+{
+  float factor[6]; /* Cholesky factor of J J^T + d^2 I */
+  v3 end;          /* end effector after the last step */
+  float motion;    /* largest bone turn summed over the steps since the factorization */
+  int locked;      /* joints left out of the factorization */
+  int valid;
+
+} cik_dls_cache;
+
+/* Forgets the cached factorization, needed before the first solve and after changing the chain */
+CIK_API CIK_INLINE void cik_dls_cache_reset(cik_dls_cache *cache)
+{
+  cache->valid = 0;
+  cache->motion = 0.0f;
+  cache->locked = 0;
+}
+
+/* Builds and factors J J^T + d^2 I for the current pose */
+CIK_API CIK_INLINE int cik_chain_dls_factor(cik_chain *chain, v3 *pos, cik_dls_cache *cache)
+{
+  int m = chain->n - 1;
+  float *locked = chain->work + 3 * m;
+  float damping = CIK_DLS_DAMPING * chain->total_len;
+  float *a = cache->factor;
+  int i;
+
+  a[0] = a[2] = a[5] = damping * damping;
+  a[1] = a[3] = a[4] = 0.0f;
+  cache->locked = 0;
+
+  for (i = 0; i < m; ++i)
+  {
+    v3 r = cik_v3_sub(pos[m], pos[i]);
+
+    if (locked[i] != 0.0f)
+    {
+      cache->locked++;
+    }
+    else if (chain->hinge_type[i])
+    {
+      v3 c = cik_v3_cross(chain->hinge_axis[i], r);
+
+      a[0] += c.x * c.x;
+      a[1] += c.y * c.x;
+      a[2] += c.y * c.y;
+      a[3] += c.z * c.x;
+      a[4] += c.z * c.y;
+      a[5] += c.z * c.z;
+    }
+    else
+    {
+      float r_2 = cik_v3_length_2(r);
+
+      a[0] += r_2 - r.x * r.x;
+      a[1] -= r.y * r.x;
+      a[2] += r_2 - r.y * r.y;
+      a[3] -= r.z * r.x;
+      a[4] -= r.z * r.y;
+      a[5] += r_2 - r.z * r.z;
+    }
+  }
+
+  cache->motion = 0.0f;
+  cache->valid = cik_sym3_factor(a);
+
+  return cache->valid;
+}
+
+/* One damped least squares step, uses cik_chain_ccd_setup state. Returns the squared error. */
+CIK_API CIK_INLINE float cik_chain_dls_step(
+    cik_chain *chain,
+    v3 *pos,              /* [n] joint positions (in/out) */
+    v3 target,            /* target position */
+    cik_dls_cache *cache, /* factorization, rebuilt when stale */
+    cik_solve_info *info  /* statistics (optional, may be 0) */
+)
+{
+  int m = chain->n - 1;
+  v3 *dirs = (v3 *)chain->work;
+  float *locked = chain->work + 3 * m;
+  v3 e = cik_v3_sub(target, pos[m]);
+  v3 turn = cik_v3(0.0f, 0.0f, 0.0f);
+  float e_2 = cik_v3_length_2(e);
+  float max_step = CIK_DLS_MAX_STEP * chain->total_len;
+  float motion = 0.0f;
+  int changed = 0;
+  v3 y;
+  int i;
+
+  if (e_2 > max_step * max_step)
+  {
+    e = cik_v3_scale(e, max_step / cik_sqrtf(e_2));
+  }
+
+  if (!cache->valid || cache->motion > CIK_DLS_CACHE_MOTION)
+  {
+    if (info)
+    {
+      info->jacobian_builds++;
+    }
+
+    if (!cik_chain_dls_factor(chain, pos, cache))
+    {
+      return e_2;
+    }
+  }
+
+  /* The turn of every joint is its columns dotted with y */
+  y = cik_sym3_solve(cache->factor, e);
+
+  for (i = 0; i < m; ++i)
+  {
+    v3 r = cik_v3_sub(pos[m], pos[i]);
+    v3 d = dirs[i];
+    v3 dir;
+    float angle;
+    int clamped;
+
+    if (locked[i] == 0.0f)
+    {
+      v3 axis = chain->hinge_axis[i];
+
+      turn = cik_v3_add(turn, chain->hinge_type[i] ? cik_v3_scale(axis, cik_v3_dot(cik_v3_cross(axis, r), y)) : cik_v3_cross(r, y));
+    }
+
+    /* Bone i turns with all joints up to and including joint i */
+    angle = cik_sqrtf_refined(cik_v3_length_2(turn));
+
+    if (angle > 1e-12f)
+    {
+      v3 u = cik_v3_scale(turn, 1.0f / angle);
+      float c = cik_cosf(angle);
+
+      d = cik_v3_add(
+          cik_v3_add(cik_v3_scale(d, c), cik_v3_scale(cik_v3_cross(u, d), cik_sinf(angle))),
+          cik_v3_scale(u, cik_v3_dot(u, d) * (1.0f - c)));
+      motion = angle > motion ? angle : motion;
+    }
+
+    if (chain->hinge_type[i])
+    {
+      clamped = cik_chain_hinge_clamp(chain, i, cik_v3_dot(d, chain->constraints[i].rest), cik_v3_dot(d, chain->constraints[i].side), &dir, info);
+
+      if (!clamped)
+      {
+        continue;
+      }
+
+      clamped = clamped == 2;
+    }
+    else
+    {
+      v3 child = cik_v3_add(pos[i], d);
+
+      clamped = cik_constraint_enforce_cone(&chain->constraints[i], pos[i], &child);
+
+      if (clamped && info)
+      {
+        info->cone_active++;
+      }
+
+      dir = cik_v3_normalize_refined(cik_v3_sub(child, pos[i]));
+    }
+
+    if ((locked[i] != 0.0f) != clamped)
+    {
+      locked[i] = (float)clamped;
+      changed = 1;
+    }
+
+    dirs[i] = dir;
+  }
+
+  for (i = 0; i < m; ++i)
+  {
+    pos[i + 1] = cik_v3_add(pos[i], cik_v3_scale(dirs[i], chain->lengths[i]));
+  }
+
+  cache->motion += motion;
+  cache->end = pos[m];
+
+  if (changed)
+  {
+    cache->valid = 0;
+  }
+
+  return cik_v3_length_2(cik_v3_sub(pos[m], target));
+}
+
+/* DLS iterations without resetting info, shared by the DLS and the hybrid solver */
+CIK_API CIK_INLINE int cik_chain_dls_iterate(
+    cik_chain *chain,
+    v3 *pos,
+    v3 target,
+    float tolerance,
+    int max_iter,
+    cik_dls_cache *cache,
+    cik_solve_info *info)
+{
+  cik_dls_cache local;
+  float tolerance_2 = tolerance * tolerance;
+  float err_2 = cik_v3_length_2(cik_v3_sub(pos[chain->n - 1], target));
+  int unreachable = cik_v3_length_2(cik_v3_sub(target, pos[0])) > chain->total_len_2;
+  int i, iter;
+
+  if (!cache)
+  {
+    cache = &local;
+    cik_dls_cache_reset(cache);
+  }
+  else if (cache->locked || cik_v3_length_2(cik_v3_sub(pos[chain->n - 1], cache->end)) > tolerance_2)
+  {
+    /* The pose changed since the last solve or the factorization left out joints */
+    cik_dls_cache_reset(cache);
+  }
+
+  cik_chain_ccd_setup(chain, pos);
+
+  for (i = 0; i < chain->n - 1; ++i)
+  {
+    chain->work[3 * (chain->n - 1) + i] = 0.0f;
+  }
+
+  for (iter = 0; iter < max_iter && (unreachable || err_2 > tolerance_2); ++iter)
+  {
+    float prev_2 = err_2;
+
+    err_2 = cik_chain_dls_step(chain, pos, target, cache, info);
+
+    if (info)
+    {
+      cik_solve_info_iteration(info, err_2);
+    }
+
+    if (err_2 > prev_2)
+    {
+      cache->valid = 0;
+    }
+
+    if (unreachable && cik_sqrtf(prev_2) - cik_sqrtf(err_2) < tolerance)
+    {
+      break;
+    }
+  }
+
+  if (info)
+  {
+    info->error = cik_sqrtf(err_2);
+  }
+
+  return unreachable ? 3 : (err_2 <= tolerance_2 ? 0 : 1);
+}
+
+/* Same return codes as cik_chain_solve. The cache is optional (may be 0), pass the same cache
+ * for every solve of one chain to reuse the factorization between nearby targets.
+ */
+CIK_API CIK_INLINE int cik_chain_solve_dls_ex(
+    cik_chain *chain,
+    v3 *pos,              /* [n] joint positions (in/out) */
+    v3 target,            /* target position */
+    float tolerance,
+    int max_iter,
+    cik_dls_cache *cache, /* factorization reused across solves (optional, may be 0) */
+    cik_solve_info *info  /* statistics (optional, may be 0) */
+)
+{
+  if (info)
+  {
+    cik_solve_info_begin(info);
+  }
+
+  return cik_chain_dls_iterate(chain, pos, target, tolerance, max_iter, cache, info);
+}
+
+/* FABRIK until the error is below switch_error or a FABRIK iteration removes less than
+ * (1 - CIK_DLS_HYBRID_RATIO) of the error, DLS from there on. FABRIK makes the large moves
+ * cheaply and DLS finishes in few steps. max_iter counts both solvers together.
+ */
+CIK_API CIK_INLINE int cik_chain_solve_hybrid_ex(
+    cik_chain *chain,
+    v3 *pos,              /* [n] joint positions (in/out) */
+    v3 target,            /* target position */
+    float switch_error,   /* end effector error at which DLS takes over */
+    float tolerance,
+    int max_iter,
+    cik_dls_cache *cache, /* factorization reused across solves (optional, may be 0) */
+    cik_solve_info *info  /* statistics (optional, may be 0) */
+)
+{
+  cik_fabrik_state state;
+  float switch_2 = switch_error * switch_error;
+
+  if (cik_fabrik_begin(&state, chain, pos, target, tolerance, max_iter, info))
+  {
+    return cik_fabrik_end(&state);
+  }
+
+  while (state.error_2 > switch_2)
+  {
+    float prev_2 = state.error_2;
+
+    if (cik_fabrik_step(&state))
+    {
+      return cik_fabrik_end(&state);
+    }
+
+    if (state.error_2 > CIK_DLS_HYBRID_RATIO * CIK_DLS_HYBRID_RATIO * prev_2)
+    {
+      break;
+    }
+  }
+
+  return cik_chain_dls_iterate(chain, pos, target, tolerance, max_iter - state.iterations, cache, info);
+}
+
+/* cik_fabrik_solve with DLS, same arguments and return codes */
+CIK_API CIK_INLINE int cik_dls_solve(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+  if (n > CIK_MAX_JOINTS || cik_chain_init(&chain, scratch, pos, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 2;
+  }
+
+  return cik_chain_solve_dls_ex(&chain, pos, target, tolerance, max_iter, 0, 0);
+}
+
+/* ---------------------- FABRIK Tree Solver ---------------------- */
+/* Solves a branching skeleton with several end effectors in one call (multi end effector
+ * FABRIK). Joint j hangs off joint parent[j] with parent[0] = -1 for the root and
+ * parent[j] < j otherwise, so joints are stored parents first. The constraint arrays are
+ * indexed by bone, bone j - 1 runs from parent[j] to joint j (a serial chain with
+ * parent[j] = j - 1 uses the same arrays as cik_fabrik_solve).
+ *
+ * The forward pass walks from the leaves to the root. Every branch pulls its sub-base
+ * towards itself and a sub-base with several branches moves to the centroid of their pulls.
+ * The backward pass walks from the root to the leaves and restores the bone lengths with
+ * the constraints. Branches without an effector only follow their parent.
+ *
+ * The per joint state lives in the scratch memory: lengths, compiled constraint tables,
+ * centroid sums, pull counts and a flag for joints with an effector below them.
+ */
+#define CIK_FABRIK_TREE_SCRATCH_FLOATS(n) ((6 + CIK_CONSTRAINT_FLOATS) * (n))
+
+CIK_API CIK_INLINE unsigned long cik_fabrik_tree_scratch_size(int n)
+{
+  return n < 2 ? 0 : (unsigned long)CIK_FABRIK_TREE_SCRATCH_FLOATS(n) * (unsigned long)sizeof(float);
+}
+
+/* Largest squared distance of an effector from its target */
+CIK_API CIK_INLINE float cik_fabrik_tree_error_2(v3 *pos, int *effectors, v3 *targets, int effector_count)
+{
+  float err_2 = 0.0f;
+  int e;
+
+  for (e = 0; e < effector_count; ++e)
+  {
+    float d_2 = cik_v3_length_2(cik_v3_sub(pos[effectors[e]], targets[e]));
+    err_2 = d_2 > err_2 ? d_2 : err_2;
+  }
+
+  return err_2;
+}
+
+/* 0 = every effector within tolerance
+ * 1 = max_iter reached (did not converge)
+ * 2 = invalid input (n < 2, no scratch memory, bad parent or effector indices, degenerate lengths)
+ *
+ * There is no unreachable code, effectors that cannot be reached end up as close as the
+ * other effectors allow. info->error is the largest effector error.
+ */
+CIK_API CIK_INLINE int cik_fabrik_solve_tree(
+    v3 *pos,            /* [n] joint positions (in/out), pos[0] is the root */
+    int *parent,        /* [n] parent joint, -1 for the root, parent[j] < j */
+    int n,              /* number of joints */
+    int *effectors,     /* [effector_count] joints with a target */
+    v3 *targets,        /* [effector_count] target positions */
+    int effector_count, /* number of effectors */
+    float *max_angle,   /* spherical limits [n-1], per bone */
+    int *hinge_type,    /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,     /* hinge axes */
+    float *hinge_min,   /* hinge min angles */
+    float *hinge_max,   /* hinge max angles */
+    float tolerance,
+    int max_iter,
+    void *scratch,       /* cik_fabrik_tree_scratch_size(n) bytes, aligned for float */
+    cik_solve_info *info /* statistics (optional, may be 0) */
+)
+{
+  float *lengths = (float *)scratch;
+  cik_constraint *constraints = (cik_constraint *)(lengths + n);
+  v3 *sums = (v3 *)(constraints + n);
+  float *counts = (float *)(sums + n);
+  float *active = counts + n;
+  float tolerance_2 = tolerance * tolerance;
+  float err_2;
+  v3 root;
+  int iter, j, e;
+
+  if (info)
+  {
+    cik_solve_info_begin(info);
+  }
+
+  if (n < 2 || !scratch || parent[0] != -1 || effector_count < 1)
+  {
+    return 2;
+  }
+
+  for (j = 0; j < n; ++j)
+  {
+    active[j] = 0.0f;
+  }
+
+  for (j = 1; j < n; ++j)
+  {
+    v3 bone;
+
+    if (parent[j] < 0 || parent[j] >= j)
+    {
+      return 2;
+    }
+
+    bone = cik_v3_sub(pos[j], pos[parent[j]]);
+    lengths[j] = cik_v3_length(bone);
+
+    if (lengths[j] < 1e-10f)
+    {
+      return 2;
+    }
+
+    bone = cik_v3_scale(bone, 1.0f / lengths[j]);
+
+    if (hinge_type[j - 1])
+    {
+      cik_constraint_compile(&constraints[j], bone, 1, 0.0f, hinge_axis[j - 1], hinge_min[j - 1], hinge_max[j - 1]);
+    }
+    else
+    {
+      cik_constraint_compile(&constraints[j], bone, 0, max_angle[j - 1], bone, 0.0f, 0.0f);
+    }
+  }
+
+  /* Mark every joint on a path from the root to an effector */
+  for (e = 0; e < effector_count; ++e)
+  {
+    if (effectors[e] < 1 || effectors[e] >= n)
+    {
+      return 2;
+    }
+
+    for (j = effectors[e]; j > 0 && active[j] == 0.0f; j = parent[j])
+    {
+      active[j] = 1.0f;
+    }
+  }
+
+  root = pos[0];
+  err_2 = cik_fabrik_tree_error_2(pos, effectors, targets, effector_count);
+
+  for (iter = 0; iter < max_iter && err_2 > tolerance_2; ++iter)
+  {
+    for (j = 0; j < n; ++j)
+    {
+      sums[j] = cik_v3(0.0f, 0.0f, 0.0f);
+      counts[j] = 0.0f;
+    }
+
+    for (e = 0; e < effector_count; ++e)
+    {
+      sums[effectors[e]] = cik_v3_add(sums[effectors[e]], targets[e]);
+      counts[effectors[e]] += 1.0f;
+    }
+
+    /* Forward reaching, children come after their parents so this visits leaves first */
+    for (j = n - 1; j > 0; --j)
+    {
+      int p = parent[j];
+
+      if (active[j] == 0.0f)
+      {
+        continue;
+      }
+
+      pos[j] = cik_v3_scale(sums[j], 1.0f / counts[j]);
+      sums[p] = cik_v3_add(sums[p], cik_v3_reposition(pos[j], pos[p], lengths[j]));
+      counts[p] += 1.0f;
+    }
+
+    /* Backward reaching */
+    pos[0] = root;
+
+    for (j = 1; j < n; ++j)
+    {
+      int p = parent[j];
+
+      pos[j] = cik_v3_reposition(pos[p], pos[j], lengths[j]);
+
+      /* Apply constraints */
+      if (hinge_type[j - 1] == 0)
+      {
+        int clamped = cik_constraint_enforce_cone(&constraints[j], pos[p], &pos[j]);
+
+        if (info)
+        {
+          info->cone_active += clamped;
+        }
+      }
+      else
+      {
+        int clamped = cik_constraint_enforce_hinge(&constraints[j], pos[p], &pos[j]);
+
+        if (info)
+        {
+          info->hinge_active += clamped;
+        }
+      }
+    }
+
+    err_2 = cik_fabrik_tree_error_2(pos, effectors, targets, effector_count);
+
+    if (info)
+    {
+      cik_solve_info_iteration(info, err_2);
+    }
+  }
+
+  if (info)
+  {
+    info->error = cik_sqrtf(err_2);
+  }
+
+  return err_2 <= tolerance_2 ? 0 : 1;
+}
+
+/* ---------------------- FABRIK Scheduler ---------------------- */
+/* Spends a shared iteration or time budget on many chains, always iterating the chain with
+ * the largest remaining error first. Chains that run out of budget keep their partial pose.
+ */
+typedef struct cik_fabrik_job
+{
+  cik_chain *chain; /* initialized chain */
+  v3 *pos;          /* [n] joint positions (in/out) */
+  v3 target;        /* target position */
+  float tolerance;  /* tolerance */
+  int max_iter;     /* iteration cap for this chain */
+
+  int result;     /* 0 = converged, 1 = budget, max_iter or progress exhausted (partial pose), 3 = unreachable, 4 = inside the minimum reach */
+  int iterations; /* iterations spent on this chain */
+  float error;    /* final distance from the end effector to the target */
+
+  cik_fabrik_state state; /* internal: resumable solve, state.error_2 is the heap key */
+
+} cik_fabrik_job;
+
+typedef struct cik_fabrik_budget
+{
+  int iterations;         /* total iterations over all jobs, 0 = unlimited */
+  double nanoseconds;     /* total time over all jobs, 0 = unlimited */
+  double (*now_ns)(void); /* clock for the time budget, e.g. perf_platform_current_time_nanoseconds */
+
+} cik_fabrik_budget;
+
+/* Restores the max-heap property (largest error on top) below heap[k] */
+CIK_API CIK_INLINE void cik_fabrik_heap_down(cik_fabrik_job *jobs, int *heap, int size, int k)
+{
+  for (;;)
+  {
+    int largest = k;
+    int left = 2 * k + 1;
+    int right = left + 1;
+    int tmp;
+
+    if (left < size && jobs[heap[left]].state.error_2 > jobs[heap[largest]].state.error_2)
+    {
+      largest = left;
+    }
+
+    if (right < size && jobs[heap[right]].state.error_2 > jobs[heap[largest]].state.error_2)
+    {
+      largest = right;
+    }
+
+    if (largest == k)
+    {
+      return;
+    }
+
+    tmp = heap[k];
+    heap[k] = heap[largest];
+    heap[largest] = tmp;
+    k = largest;
+  }
+}
+
+/* Solves all jobs within the budget and returns the number of iterations spent.
+ *
+ * Chains already within tolerance are left untouched. Unreachable targets are stretched
+ * toward (result 3) and 3 joint chains try the closed-form solver first (1 iteration), both
+ * before the budget is checked (see cik_fabrik_begin). Every further iteration goes to the
+ * job with the largest error until it converges, hits its max_iter or the budget runs out.
+ * The clock is read once per iteration.
+ */
+CIK_API CIK_INLINE int cik_fabrik_schedule(
+    cik_fabrik_job *jobs,      /* [count] jobs (in/out) */
+    int count,                 /* number of jobs */
+    cik_fabrik_budget *budget, /* shared budget */
+    int *heap                  /* [count] scratch memory for the priority queue */
+)
+{
+  double start = (budget->nanoseconds > 0.0 && budget->now_ns) ? budget->now_ns() : 0.0;
+  int spent = 0;
+  int size = 0;
+  int j;
+
+  for (j = 0; j < count; ++j)
+  {
+    cik_fabrik_job *job = &jobs[j];
+    cik_fabrik_state *state = &job->state;
+    float tolerance_2 = job->tolerance * job->tolerance;
+
+    if (cik_v3_length_2(cik_v3_sub(job->pos[job->chain->n - 1], job->target)) <= tolerance_2)
+    {
+      /* Already within tolerance, costs nothing */
+      state->result = 0;
+      state->iterations = 0;
+    }
+    else if (!cik_fabrik_begin(state, job->chain, job->pos, job->target, job->tolerance, job->max_iter, 0))
+    {
+      heap[size++] = j;
+    }
+
+    spent += state->iterations;
+  }
+
+  for (j = size / 2 - 1; j >= 0; --j)
+  {
+    cik_fabrik_heap_down(jobs, heap, size, j);
+  }
+
+  while (size > 0)
+  {
+    if (budget->iterations > 0 && spent >= budget->iterations)
+    {
+      break;
+    }
+
+    if (budget->nanoseconds > 0.0 && budget->now_ns && budget->now_ns() - start >= budget->nanoseconds)
+    {
+      break;
+    }
+
+    spent++;
+
+    if (cik_fabrik_step(&jobs[heap[0]].state))
+    {
+      heap[0] = heap[--size];
+    }
+
+    cik_fabrik_heap_down(jobs, heap, size, 0);
+  }
+
+  /* Jobs still in the heap ran out of budget and report their partial pose */
+  for (j = 0; j < count; ++j)
+  {
+    jobs[j].result = jobs[j].state.result;
+    jobs[j].iterations = jobs[j].state.iterations;
+    jobs[j].error = cik_sqrtf(cik_v3_length_2(cik_v3_sub(jobs[j].pos[jobs[j].chain->n - 1], jobs[j].target)));
+  }
+
+  return spent;
+}
+
+/* ---------------------- FABRIK Batch Solver ---------------------- */
+/* Solves many chains with the same joint count and constraint layout in one call.
+ *
+ * Joint positions are laid out structure-of-arrays: joint i of chain c is stored at
+ * x[i * count + c], y[i * count + c] and z[i * count + c]. The constraint arrays are
+ * shared by all chains and indexed exactly like in cik_fabrik_solve.
+ *
+ * Chains are gathered into blocks of CIK_BATCH_LANES lanes. Every lane loop has a fixed
+ * trip count, no cross-lane dependencies and no branches (converged lanes are blended out
+ * with a 0/1 mask), so the compiler can vectorize it across chains. Each lane runs exactly
+ * the operations cik_fabrik_solve runs for that chain. The positions match the scalar
+ * solver to within 1e-4 times the chain length and the return codes are identical.
+ *
+ * The single threaded solvers stream the chains through one block: a lane whose chain is done
+ * takes the next pending chain right away (see cik_fabrik_batch_solve_stream), so chains that
+ * need many iterations do not leave the other lanes idle.
+ *
+ * With GCC the lane loops vectorize at -O3, the cone select additionally needs -fno-trapping-math.
+ */
+#ifndef CIK_BATCH_LANES
+#define CIK_BATCH_LANES 8
+#endif
+
+/* 1 / length, 0 for zero vectors (no compare, so lane loops stay branch-free) */
+CIK_API CIK_INLINE float cik_batch_inv_length(float x, float y, float z)
+{
+#ifdef CIK_USE_SSE
+  /* Same estimate as cik_sse_inv_length so the lanes match the scalar SSE solver */
+  float l2 = x * x + y * y + z * z;
+  return (l2 > 1e-18f) ? cik_invsqrt(l2) : 0.0f;
+#else
+  return 1.0f / (cik_sqrtf(x * x + y * y + z * z) + 1e-30f);
+#endif
+}
+
+/* Lengths and 1 / lengths (0 for zero vectors) of all lanes from their squared lengths. Goes
+ * through cik_invsqrt_lanes so the hot lane loops vectorize, rounds exactly like
+ * cik_batch_inv_length and cik_sqrtf.
+ */
+CIK_API CIK_INLINE void cik_batch_lengths(const float *l2, float *length, float *inv)
+{
+  int l;
+
+  cik_invsqrt_lanes(l2, inv, CIK_BATCH_LANES);
+
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    length[l] = l2[l] * inv[l];
+#ifdef CIK_USE_SSE
+    inv[l] = (float)(l2[l] > 1e-18f) * inv[l];
+#else
+    inv[l] = 1.0f / (length[l] + 1e-30f);
+#endif
+  }
+}
+
+/* Floats of scratch memory needed by the batch solver for n joints (10 joint arrays per lane,
+ * the shared limit cos/sin pairs and one chain for the planar path)
+ */
+#define CIK_FABRIK_BATCH_SCRATCH_FLOATS(n) (10 * (n) * CIK_BATCH_LANES + 4 * (n) + 3 * (n) + CIK_FABRIK_SCRATCH_FLOATS(n))
+
+CIK_API CIK_INLINE unsigned long cik_fabrik_batch_scratch_size(int n)
+{
+  return n < 2 ? 0 : (unsigned long)CIK_FABRIK_BATCH_SCRATCH_FLOATS(n) * (unsigned long)sizeof(float);
+}
+
+typedef struct cik_batch_block
+{
+  float *x; /* [n * CIK_BATCH_LANES] joint arrays, all in the batch scratch memory */
+  float *y;
+  float *z;
+  float *lengths;
+  float *rest_x;
+  float *rest_y;
+  float *rest_z;
+  float *side_x; /* hinge: axis x rest, cone: a direction perpendicular to rest */
+  float *side_y;
+  float *side_z;
+  float *limits; /* [4 * n] cos_a, sin_a, cos_b, sin_b of the compiled constraint per joint */
+  float *planar; /* [3 * n + CIK_FABRIK_SCRATCH_FLOATS(n)] joint positions and chain scratch of a planar lane */
+  float target_x[CIK_BATCH_LANES];
+  float target_y[CIK_BATCH_LANES];
+  float target_z[CIK_BATCH_LANES];
+  float total_len[CIK_BATCH_LANES];
+  float inner_len[CIK_BATCH_LANES]; /* minimum reach, see cik_chain */
+  float error_2[CIK_BATCH_LANES];   /* squared end effector error after the last iteration */
+  float stalls[CIK_BATCH_LANES];    /* consecutive iterations without progress */
+  float active[CIK_BATCH_LANES];    /* 1.0f while the lane is iterating, 0.0f otherwise */
+  float tolerance[CIK_BATCH_LANES];  /* per lane tolerance, see cik_fabrik_lod */
+  float iterations[CIK_BATCH_LANES]; /* iterations the lane has left */
+  float constrain[CIK_BATCH_LANES];  /* 1.0f to enforce the joint limits, 0.0f to skip them */
+  int result[CIK_BATCH_LANES];
+  int chain[CIK_BATCH_LANES]; /* batch chain held by the lane, -1 = empty */
+  int tier[CIK_BATCH_LANES];  /* level of detail of that chain */
+  long iterations_run;        /* block iterations since cik_batch_block_init */
+  long lane_iterations_run;   /* lane iterations of them that moved a chain (active lanes) */
+
+} cik_batch_block;
+
+/* Blends "value" into "dst" on active lanes. Exact for a 0/1 mask. */
+#define CIK_BATCH_BLEND(dst, value, mask) ((mask) * (value) + (1.0f - (mask)) * (dst))
+
+/* Solves lane l in joint-angle space if all bones are hinges sharing one axis (see
+ * cik_chain_is_planar), with the scalar solver on a copy of the lane in b->planar. Returns 0
+ * if the chain is not planar.
+ */
+CIK_API CIK_INLINE int cik_fabrik_batch_lane_planar(
+    cik_batch_block *b,
+    int l,
+    int n,
+    float *max_angle,
+    int *hinge_type,
+    v3 *hinge_axis,
+    float *hinge_min,
+    float *hinge_max)
+{
+  v3 *pos = (v3 *)b->planar;
+  cik_chain chain;
+  cik_fabrik_state state;
+  int i;
+
+  chain.n = n;
+  chain.hinge_type = hinge_type;
+  chain.hinge_axis = hinge_axis;
+
+  if (!cik_chain_is_planar(&chain))
+  {
+    return 0;
+  }
+
+  for (i = 0; i < n; ++i)
+  {
+    pos[i] = cik_v3(b->x[i * CIK_BATCH_LANES + l], b->y[i * CIK_BATCH_LANES + l], b->z[i * CIK_BATCH_LANES + l]);
+  }
+
+  if (cik_chain_init(&chain, b->planar + 3 * n, pos, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) != 0)
+  {
+    return 0;
+  }
+
+  if (!cik_fabrik_begin(&state, &chain, pos, cik_v3(b->target_x[l], b->target_y[l], b->target_z[l]), b->tolerance[l], (int)b->iterations[l], 0))
+  {
+    while (!cik_fabrik_step(&state))
+    {
+    }
+  }
+
+  for (i = 1; i < n; ++i)
+  {
+    b->x[i * CIK_BATCH_LANES + l] = pos[i].x;
+    b->y[i * CIK_BATCH_LANES + l] = pos[i].y;
+    b->z[i * CIK_BATCH_LANES + l] = pos[i].z;
+  }
+
+  b->error_2[l] = state.error_2;
+  b->active[l] = 0.0f;
+  b->result[l] = cik_fabrik_end(&state);
+
+  return 1;
+}
+
+/* Starts the solve of lane l if it is active: compiles the constraints against the current
+ * pose, solves two bones in closed form and planar hinge chains in joint-angle space and
+ * takes a degenerate, unreachable or minimum reach lane out (see cik_fabrik_begin)
+ */
+CIK_API CIK_INLINE void cik_fabrik_batch_lane_begin(
+    cik_batch_block *b,
+    int l,
+    int n,
+    float *max_angle,
+    int *hinge_type,
+    v3 *hinge_axis,
+    float *hinge_min,
+    float *hinge_max)
+{
+  int e = (n - 1) * CIK_BATCH_LANES + l;
+  float dx, dy, dz, inner, inv;
+  int i;
+
+  b->total_len[l] = 0.0f;
+  b->result[l] = b->active[l] > 0.0f ? 1 : b->result[l];
+
+  /* Precompute lengths and compile the constraints */
+  for (i = 0; i < n - 1; ++i)
+  {
+    int k = i * CIK_BATCH_LANES + l;
+    cik_constraint c;
+
+    dx = b->x[k + CIK_BATCH_LANES] - b->x[k];
+    dy = b->y[k + CIK_BATCH_LANES] - b->y[k];
+    dz = b->z[k + CIK_BATCH_LANES] - b->z[k];
+    inv = cik_batch_inv_length(dx, dy, dz);
+
+    b->lengths[k] = cik_sqrtf(dx * dx + dy * dy + dz * dz);
+    b->total_len[l] += b->lengths[k];
+
+    cik_constraint_compile(&c, cik_v3(dx * inv, dy * inv, dz * inv), hinge_type[i], max_angle[i], hinge_axis[i], hinge_min[i], hinge_max[i]);
+
+    /* Cones keep the fallback direction of cik_constraint_enforce_cone in side */
+    c.side = hinge_type[i] ? c.side : cik_v3_perpendicular(c.rest);
+    b->rest_x[k] = c.rest.x;
+    b->rest_y[k] = c.rest.y;
+    b->rest_z[k] = c.rest.z;
+    b->side_x[k] = c.side.x;
+    b->side_y[k] = c.side.y;
+    b->side_z[k] = c.side.z;
+
+    /* The limits only depend on the joint */
+    b->limits[4 * i + 0] = c.cos_a;
+    b->limits[4 * i + 1] = c.sin_a;
+    b->limits[4 * i + 2] = c.cos_b;
+    b->limits[4 * i + 3] = c.sin_b;
+  }
+
+  /* Minimum reach and start error */
+  dx = b->x[e] - b->target_x[l];
+  dy = b->y[e] - b->target_y[l];
+  dz = b->z[e] - b->target_z[l];
+
+  b->inner_len[l] = 0.0f;
+  b->error_2[l] = dx * dx + dy * dy + dz * dz;
+  b->stalls[l] = 0.0f;
+
+  for (i = 0; i < n - 1; ++i)
+  {
+    inner = 2.0f * b->lengths[i * CIK_BATCH_LANES + l] - b->total_len[l];
+    b->inner_len[l] = inner > b->inner_len[l] ? inner : b->inner_len[l];
+  }
+
+  /* Degenerate lengths, unreachable targets and targets inside the minimum reach take the
+   * lane out of the iteration
+   */
+  if (b->active[l] == 0.0f)
+  {
+    return;
+  }
+
+  for (i = 0; i < n - 1; ++i)
+  {
+    if (b->lengths[i * CIK_BATCH_LANES + l] < 1e-10f)
+    {
+      b->active[l] = 0.0f;
+      b->result[l] = 2;
+      return;
+    }
+  }
+
+  dx = b->target_x[l] - b->x[l];
+  dy = b->target_y[l] - b->y[l];
+  dz = b->target_z[l] - b->z[l];
+  inner = b->inner_len[l] - b->tolerance[l];
+
+  if (dx * dx + dy * dy + dz * dz <= b->total_len[l] * b->total_len[l])
+  {
+    if (inner > 0.0f && dx * dx + dy * dy + dz * dz < inner * inner)
+    {
+      b->active[l] = 0.0f;
+      b->result[l] = 4;
+      return;
+    }
+
+    /* Two bones are solved in closed form like in cik_fabrik_begin */
+    if (n == 3)
+    {
+      v3 p[3];
+
+      for (i = 0; i < 3; ++i)
+      {
+        p[i] = cik_v3(b->x[i * CIK_BATCH_LANES + l], b->y[i * CIK_BATCH_LANES + l], b->z[i * CIK_BATCH_LANES + l]);
+      }
+
+      if (cik_solve_two_bone(p, cik_v3(b->target_x[l], b->target_y[l], b->target_z[l]), p[1], max_angle, hinge_type, hinge_axis, hinge_min, hinge_max) == 0)
+      {
+        for (i = 1; i < 3; ++i)
+        {
+          b->x[i * CIK_BATCH_LANES + l] = p[i].x;
+          b->y[i * CIK_BATCH_LANES + l] = p[i].y;
+          b->z[i * CIK_BATCH_LANES + l] = p[i].z;
+        }
+
+        b->error_2[l] = 0.0f;
+        b->active[l] = 0.0f;
+        b->result[l] = 0;
+        return;
+      }
+    }
+
+    /* Hinges sharing one axis are solved like in cik_fabrik_begin, unless the lane's level
+     * of detail skips the joint limits
+     */
+    if (b->constrain[l] > 0.0f && cik_fabrik_batch_lane_planar(b, l, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max))
+    {
+      return;
+    }
+
+    /* No iterations left, the pose stays as it is (result 1) */
+    b->active[l] *= (float)(b->iterations[l] > 0.0f);
+    return;
+  }
+
+  /* Target is unreachable — stretch arm toward it */
+  inv = cik_batch_inv_length(dx, dy, dz);
+
+  for (i = 1; i < n; ++i)
+  {
+    int k = i * CIK_BATCH_LANES + l;
+    float d = b->lengths[k - CIK_BATCH_LANES];
+
+    b->x[k] = b->x[k - CIK_BATCH_LANES] + dx * inv * d;
+    b->y[k] = b->y[k - CIK_BATCH_LANES] + dy * inv * d;
+    b->z[k] = b->z[k - CIK_BATCH_LANES] + dz * inv * d;
+  }
+
+  b->active[l] = 0.0f;
+  b->result[l] = 3;
+}
+
+/* cik_fabrik_batch_lane_begin for every lane */
+CIK_API CIK_INLINE void cik_fabrik_batch_block_begin(
+    cik_batch_block *b,
+    int n,
+    float *max_angle,
+    int *hinge_type,
+    v3 *hinge_axis,
+    float *hinge_min,
+    float *hinge_max)
+{
+  int l;
+
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    cik_fabrik_batch_lane_begin(b, l, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max);
+  }
+}
+
+/* Runs one iteration on the active lanes, returns 1 without iterating once no lane is left */
+CIK_API CIK_INLINE int cik_fabrik_batch_block_step(
+    cik_batch_block *b,
+    int n,
+    int *hinge_type,
+    float *hinge_min,
+    float *hinge_max)
+{
+  float running = 0.0f;
+  float constrained = 0.0f;
+  float root_x[CIK_BATCH_LANES];
+  float root_y[CIK_BATCH_LANES];
+  float root_z[CIK_BATCH_LANES];
+  float l2[CIK_BATCH_LANES], length[CIK_BATCH_LANES], inv[CIK_BATCH_LANES];
+  float o2[CIK_BATCH_LANES], olength[CIK_BATCH_LANES], oinv[CIK_BATCH_LANES];
+  float *m = b->active;
+  int i, l;
+
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    running += m[l];
+    constrained += m[l] * b->constrain[l];
+  }
+
+  if (running == 0.0f)
+  {
+    return 1;
+  }
+
+  b->iterations_run++;
+  b->lane_iterations_run += (long)running;
+
+  /* Forward reaching */
+  {
+    float *xe = b->x + (n - 1) * CIK_BATCH_LANES;
+    float *ye = b->y + (n - 1) * CIK_BATCH_LANES;
+    float *ze = b->z + (n - 1) * CIK_BATCH_LANES;
+
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      root_x[l] = b->x[l];
+      root_y[l] = b->y[l];
+      root_z[l] = b->z[l];
+      xe[l] = CIK_BATCH_BLEND(xe[l], b->target_x[l], m[l]);
+      ye[l] = CIK_BATCH_BLEND(ye[l], b->target_y[l], m[l]);
+      ze[l] = CIK_BATCH_BLEND(ze[l], b->target_z[l], m[l]);
+    }
+  }
+
+  for (i = n - 2; i >= 0; --i)
+  {
+    float *x0 = b->x + i * CIK_BATCH_LANES, *y0 = b->y + i * CIK_BATCH_LANES, *z0 = b->z + i * CIK_BATCH_LANES;
+    float *x1 = x0 + CIK_BATCH_LANES, *y1 = y0 + CIK_BATCH_LANES, *z1 = z0 + CIK_BATCH_LANES;
+    float *len = b->lengths + i * CIK_BATCH_LANES;
+
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      float dx = x0[l] - x1[l];
+      float dy = y0[l] - y1[l];
+      float dz = z0[l] - z1[l];
+
+      l2[l] = dx * dx + dy * dy + dz * dz;
+    }
+
+    cik_batch_lengths(l2, length, inv);
+
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      float dx = x0[l] - x1[l];
+      float dy = y0[l] - y1[l];
+      float dz = z0[l] - z1[l];
+
+      x0[l] = CIK_BATCH_BLEND(x0[l], x1[l] + dx * inv[l] * len[l], m[l]);
+      y0[l] = CIK_BATCH_BLEND(y0[l], y1[l] + dy * inv[l] * len[l], m[l]);
+      z0[l] = CIK_BATCH_BLEND(z0[l], z1[l] + dz * inv[l] * len[l], m[l]);
+    }
+  }
+
+  /* Backward reaching */
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    b->x[l] = CIK_BATCH_BLEND(b->x[l], root_x[l], m[l]);
+    b->y[l] = CIK_BATCH_BLEND(b->y[l], root_y[l], m[l]);
+    b->z[l] = CIK_BATCH_BLEND(b->z[l], root_z[l], m[l]);
+  }
+
+  for (i = 0; i < n - 1; ++i)
+  {
+    float *x0 = b->x + i * CIK_BATCH_LANES, *y0 = b->y + i * CIK_BATCH_LANES, *z0 = b->z + i * CIK_BATCH_LANES;
+    float *x1 = x0 + CIK_BATCH_LANES, *y1 = y0 + CIK_BATCH_LANES, *z1 = z0 + CIK_BATCH_LANES;
+    float *len = b->lengths + i * CIK_BATCH_LANES;
+    float *rx = b->rest_x + i * CIK_BATCH_LANES;
+    float *ry = b->rest_y + i * CIK_BATCH_LANES;
+    float *rz = b->rest_z + i * CIK_BATCH_LANES;
+    float *sx = b->side_x + i * CIK_BATCH_LANES;
+    float *sy = b->side_y + i * CIK_BATCH_LANES;
+    float *sz = b->side_z + i * CIK_BATCH_LANES;
+    float *lim = b->limits + 4 * i;
+
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      float dx = x1[l] - x0[l];
+      float dy = y1[l] - y0[l];
+      float dz = z1[l] - z0[l];
+
+      l2[l] = dx * dx + dy * dy + dz * dz;
+    }
+
+    cik_batch_lengths(l2, length, inv);
+
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      float dx = x1[l] - x0[l];
+      float dy = y1[l] - y0[l];
+      float dz = z1[l] - z0[l];
+
+      x1[l] = CIK_BATCH_BLEND(x1[l], x0[l] + dx * inv[l] * len[l], m[l]);
+      y1[l] = CIK_BATCH_BLEND(y1[l], y0[l] + dy * inv[l] * len[l], m[l]);
+      z1[l] = CIK_BATCH_BLEND(z1[l], z0[l] + dz * inv[l] * len[l], m[l]);
+    }
+
+    /* No active lane enforces the joint limits (see cik_fabrik_lod) */
+    if (constrained == 0.0f)
+    {
+      continue;
+    }
+
+    /* Bone lengths after the move, shared by both constraint types */
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      float bx = x1[l] - x0[l];
+      float by = y1[l] - y0[l];
+      float bz = z1[l] - z0[l];
+
+      l2[l] = bx * bx + by * by + bz * bz;
+    }
+
+    cik_batch_lengths(l2, length, inv);
+
+    /* Apply constraints. The joint type is shared by all lanes so this branch is uniform. */
+    if (hinge_type[i] == 0)
+    {
+      float cosmax = lim[0];
+      float sinmax = lim[1];
+
+      /* ortho = normalize(dir - rest * cosang) */
+      for (l = 0; l < CIK_BATCH_LANES; ++l)
+      {
+        float dx = (x1[l] - x0[l]) * inv[l];
+        float dy = (y1[l] - y0[l]) * inv[l];
+        float dz = (z1[l] - z0[l]) * inv[l];
+        float cosang = rx[l] * dx + ry[l] * dy + rz[l] * dz;
+        float ox = dx - rx[l] * cosang;
+        float oy = dy - ry[l] * cosang;
+        float oz = dz - rz[l] * cosang;
+
+        o2[l] = ox * ox + oy * oy + oz * oz;
+      }
+
+      cik_batch_lengths(o2, olength, oinv);
+
+      /* Spherical cone, both outcomes are computed and the clamped one is blended in */
+      for (l = 0; l < CIK_BATCH_LANES; ++l)
+      {
+        float dx = (x1[l] - x0[l]) * inv[l];
+        float dy = (y1[l] - y0[l]) * inv[l];
+        float dz = (z1[l] - z0[l]) * inv[l];
+        float cosang = rx[l] * dx + ry[l] * dy + rz[l] * dz;
+        float clamp = m[l] * b->constrain[l] * (float)(cosang < cosmax);
+
+        /* side when dir is opposite to rest */
+        float flat = (float)(o2[l] <= 1e-12f);
+        float ox = CIK_BATCH_BLEND((dx - rx[l] * cosang) * oinv[l], sx[l], flat);
+        float oy = CIK_BATCH_BLEND((dy - ry[l] * cosang) * oinv[l], sy[l], flat);
+        float oz = CIK_BATCH_BLEND((dz - rz[l] * cosang) * oinv[l], sz[l], flat);
+        float d = length[l];
+
+        x1[l] = CIK_BATCH_BLEND(x1[l], x0[l] + (rx[l] * cosmax + ox * sinmax) * d, clamp);
+        y1[l] = CIK_BATCH_BLEND(y1[l], y0[l] + (ry[l] * cosmax + oy * sinmax) * d, clamp);
+        z1[l] = CIK_BATCH_BLEND(z1[l], z0[l] + (rz[l] * cosmax + oz * sinmax) * d, clamp);
+      }
+    }
+    else
+    {
+      float range = hinge_max[i] - hinge_min[i];
+
+      /* In plane length */
+      for (l = 0; l < CIK_BATCH_LANES; ++l)
+      {
+        float bx = x1[l] - x0[l];
+        float by = y1[l] - y0[l];
+        float bz = z1[l] - z0[l];
+        float hx = bx * rx[l] + by * ry[l] + bz * rz[l];
+        float hy = bx * sx[l] + by * sy[l] + bz * sz[l];
+
+        o2[l] = hx * hx + hy * hy;
+      }
+
+      cik_batch_lengths(o2, olength, oinv);
+
+      /* Hinge, same steps as cik_constraint_enforce_hinge with the branches as blends */
+      for (l = 0; l < CIK_BATCH_LANES; ++l)
+      {
+        float bx = x1[l] - x0[l];
+        float by = y1[l] - y0[l];
+        float bz = z1[l] - z0[l];
+        float d = length[l];
+        float hx = bx * rx[l] + by * ry[l] + bz * rz[l];
+        float hy = bx * sx[l] + by * sy[l] + bz * sz[l];
+
+        /* cik_sqrtf_refined of the in plane length */
+        float w = olength[l];
+        float flat, after_a, before_b, inside, use_a, move;
+
+        w = (float)(w > 1e-18f) * 0.5f * (w + o2[l] / (w + (float)(w <= 1e-18f)));
+        flat = (float)(w < 1e-8f);
+
+        /* Unit in plane direction, (1, 0) for a bone along the axis */
+        hx = CIK_BATCH_BLEND(hx / (w + flat), 1.0f, flat);
+        hy = CIK_BATCH_BLEND(hy / (w + flat), 0.0f, flat);
+
+        after_a = lim[0] * hy - lim[1] * hx;
+        before_b = hx * lim[3] - hy * lim[2];
+        inside = (range >= CIK_PI_DOUBLED) ? 1.0f : (range <= CIK_PI) ? (float)(after_a >= 0.0f && before_b >= 0.0f) : (float)(after_a >= 0.0f || before_b >= 0.0f);
+        use_a = (float)(lim[0] * hx + lim[1] * hy >= lim[2] * hx + lim[3] * hy);
+
+        hx = CIK_BATCH_BLEND(CIK_BATCH_BLEND(lim[2], lim[0], use_a), hx, inside);
+        hy = CIK_BATCH_BLEND(CIK_BATCH_BLEND(lim[3], lim[1], use_a), hy, inside);
+
+        /* Zero length bones are left untouched */
+        move = m[l] * b->constrain[l] * (float)(d >= 1e-8f);
+
+        x1[l] = CIK_BATCH_BLEND(x1[l], x0[l] + (rx[l] * hx + sx[l] * hy) * d, move);
+        y1[l] = CIK_BATCH_BLEND(y1[l], y0[l] + (ry[l] * hx + sy[l] * hy) * d, move);
+        z1[l] = CIK_BATCH_BLEND(z1[l], z0[l] + (rz[l] * hx + sz[l] * hy) * d, move);
+      }
+    }
+  }
+
+  /* Check convergence */
+  {
+    float *xe = b->x + (n - 1) * CIK_BATCH_LANES;
+    float *ye = b->y + (n - 1) * CIK_BATCH_LANES;
+    float *ze = b->z + (n - 1) * CIK_BATCH_LANES;
+
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      float dx = xe[l] - b->target_x[l];
+      float dy = ye[l] - b->target_y[l];
+      float dz = ze[l] - b->target_z[l];
+      float err_2 = dx * dx + dy * dy + dz * dz;
+      float converged = m[l] * (float)(err_2 <= b->tolerance[l] * b->tolerance[l]);
+      float stopped;
+
+      /* Same stall rule as cik_fabrik_step, lanes without iterations left stop as well */
+      b->stalls[l] = (b->stalls[l] + 1.0f) * (float)cik_fabrik_no_progress(err_2, b->error_2[l]);
+      b->error_2[l] = err_2;
+      b->iterations[l] -= m[l];
+      stopped = (m[l] - converged) * (float)((CIK_FABRIK_STALL_SWEEPS > 0 && b->stalls[l] >= (float)CIK_FABRIK_STALL_SWEEPS) || b->iterations[l] <= 0.0f);
+
+      b->result[l] = converged > 0.0f ? 0 : b->result[l];
+      m[l] -= converged + stopped;
+    }
+  }
+
+  return 0;
+}
+
+/* Solves the active lanes, every lane until it converges, stalls or runs out of iterations */
+CIK_API CIK_INLINE void cik_fabrik_batch_block_solve(
+    cik_batch_block *b,
+    int n,
+    float *max_angle,
+    int *hinge_type,
+    v3 *hinge_axis,
+    float *hinge_min,
+    float *hinge_max)
+{
+  cik_fabrik_batch_block_begin(b, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max);
+
+  for (;;)
+  {
+    if (cik_fabrik_batch_block_step(b, n, hinge_type, hinge_min, hinge_max))
+    {
+      break;
+    }
+  }
+}
+
+/* Levels of detail for the batch solver. A chain's importance (0 to 1, e.g. from
+ * cik_lod_importance) picks one of CIK_LOD_TIERS tiers. Tier t solves with t / CIK_LOD_TIERS
+ * of the iterations and a tolerance growing up to CIK_LOD_TOLERANCE_SCALE times at the lowest
+ * tier, tiers below CIK_LOD_CONSTRAIN_TIER skip the joint limits. Importance 0 (off screen)
+ * is tier 0 and not solved at all.
+ */
+#ifndef CIK_LOD_TIERS
+#define CIK_LOD_TIERS 4
+#endif
+
+#ifndef CIK_LOD_TOLERANCE_SCALE
+#define CIK_LOD_TOLERANCE_SCALE 8.0f
+#endif
+
+#ifndef CIK_LOD_CONSTRAIN_TIER
+#define CIK_LOD_CONSTRAIN_TIER 2
+#endif
+
+typedef struct cik_fabrik_lod
+{
+  int max_iter;    /* iteration cap */
+  float tolerance; /* tolerance */
+  int constrain;   /* 1 = enforce the joint limits, 0 = skip them */
+
+} cik_fabrik_lod;
+
+/* Tier 0 (not solved) to CIK_LOD_TIERS (full detail) of an importance in [0, 1] */
+CIK_API CIK_INLINE int cik_fabrik_lod_tier(float importance)
+{
+  float scaled = importance * (float)CIK_LOD_TIERS;
+  int tier = (int)scaled;
+
+  if (importance <= 0.0f)
+  {
+    return 0;
+  }
+
+  tier += (float)tier < scaled;
+
+  return tier > CIK_LOD_TIERS ? CIK_LOD_TIERS : tier;
+}
+
+/* Solver settings of a tier, the full tier keeps tolerance and max_iter as given */
+CIK_API CIK_INLINE cik_fabrik_lod cik_fabrik_lod_policy(int tier, float tolerance, int max_iter)
+{
+  cik_fabrik_lod lod;
+
+  tier = tier < 0 ? 0 : (tier > CIK_LOD_TIERS ? CIK_LOD_TIERS : tier);
+
+  lod.max_iter = (max_iter * tier + CIK_LOD_TIERS - 1) / CIK_LOD_TIERS;
+  lod.tolerance = tolerance * (1.0f + (CIK_LOD_TOLERANCE_SCALE - 1.0f) * (float)(CIK_LOD_TIERS - tier) / (float)CIK_LOD_TIERS);
+  lod.constrain = tier >= CIK_LOD_CONSTRAIN_TIER;
+
+  return lod;
+}
+
+/* Importance of a chain for its bounding sphere as seen from the camera: 1 up to full_distance,
+ * then falling with the projected size (full_distance / distance), 0 if not visible. Pass the
+ * frustum test of the renderer as visible, e.g. vm_frustum_is_sphere_in(frustum, center, radius).
+ */
+CIK_API CIK_INLINE float cik_lod_importance(v3 camera, v3 center, float radius, float full_distance, int visible)
+{
+  float distance = cik_sqrtf(cik_v3_length_2(cik_v3_sub(center, camera))) - radius;
+
+  if (!visible)
+  {
+    return 0.0f;
+  }
+
+  return distance <= full_distance ? 1.0f : full_distance / distance;
+}
+
+/* Dirty tracking for the batch solver, the per chain counterpart of CIK_FABRIK_SKIP_IDLE.
+ * Every chain keeps target, root and end effector of its last settled solve (result other
+ * than 1, see CIK_FABRIK_SKIP_IDLE), its result, its tier and the tolerance of that tier. A
+ * chain whose three points stay within CIK_FABRIK_IDLE_EPSILON, whose tier did not rise and
+ * whose result holds at the tolerance of its current tier (see cik_fabrik_settled_holds) is
+ * idle: it keeps pose and result and never enters a block.
+ *
+ * The history of one chain is CIK_FABRIK_BATCH_HISTORY_FLOATS floats, laid out by the
+ * CIK_FABRIK_HISTORY_* offsets.
+ */
+#define CIK_FABRIK_HISTORY_TARGET 0    /* x, y, z */
+#define CIK_FABRIK_HISTORY_ROOT 3      /* x, y, z */
+#define CIK_FABRIK_HISTORY_END 6       /* x, y, z */
+#define CIK_FABRIK_HISTORY_RESULT 9    /* -1 = none */
+#define CIK_FABRIK_HISTORY_TIER 10
+#define CIK_FABRIK_HISTORY_TOLERANCE 11
+#define CIK_FABRIK_BATCH_HISTORY_FLOATS 12
+
+/* Forgets the settled solves of count chains, e.g. after the poses were reset or the
+ * constraint arrays changed
+ */
+CIK_API CIK_INLINE void cik_fabrik_batch_history_reset(float *history, int count)
+{
+  int c;
+
+  for (c = 0; c < count; ++c)
+  {
+    history[c * CIK_FABRIK_BATCH_HISTORY_FLOATS + CIK_FABRIK_HISTORY_RESULT] = -1.0f;
+  }
+}
+
+/* Returns 1 if chain c of the SoA positions is idle at the given tier and its tolerance */
+CIK_API CIK_INLINE int cik_fabrik_batch_idle(
+    float *history, float *x, float *y, float *z, int n, int count, int c,
+    float target_x, float target_y, float target_z, int tier, float tolerance)
+{
+  float *h = history + c * CIK_FABRIK_BATCH_HISTORY_FLOATS;
+  float *ht = h + CIK_FABRIK_HISTORY_TARGET;
+  float *hr = h + CIK_FABRIK_HISTORY_ROOT;
+  float *he = h + CIK_FABRIK_HISTORY_END;
+  int e = (n - 1) * count + c;
+  float epsilon_2 = CIK_FABRIK_IDLE_EPSILON * CIK_FABRIK_IDLE_EPSILON;
+  float tx = target_x - ht[0], ty = target_y - ht[1], tz = target_z - ht[2];
+  float rx = x[c] - hr[0], ry = y[c] - hr[1], rz = z[c] - hr[2];
+  float ex = x[e] - he[0], ey = y[e] - he[1], ez = z[e] - he[2];
+
+  return cik_fabrik_settled_holds((int)h[CIK_FABRIK_HISTORY_RESULT], h[CIK_FABRIK_HISTORY_TOLERANCE], tolerance) &&
+         (float)tier <= h[CIK_FABRIK_HISTORY_TIER] &&
+         tx * tx + ty * ty + tz * tz <= epsilon_2 &&
+         rx * rx + ry * ry + rz * rz <= epsilon_2 &&
+         ex * ex + ey * ey + ez * ez <= epsilon_2;
+}
+
+/* Arguments of one batch call, shared by all of its blocks */
+typedef struct cik_fabrik_batch
+{
+  float *x;
+  float *y;
+  float *z;
+  int n;
+  int count;
+  float *target_x;
+  float *target_y;
+  float *target_z;
+  float *max_angle;
+  int *hinge_type;
+  v3 *hinge_axis;
+  float *hinge_min;
+  float *hinge_max;
+  float tolerance;
+  int max_iter;
+  int *result;
+  float *importance; /* [count] per chain importance, 0 = every chain at full detail */
+  float *history;    /* [CIK_FABRIK_BATCH_HISTORY_FLOATS * count] last settled solves, 0 = none */
+  int *order;        /* chains in solve order, 0 = all chains in index order */
+  int solved;        /* number of chains in the solve order */
+  cik_fabrik_lod lod[CIK_LOD_TIERS + 1];
+
+} cik_fabrik_batch;
+
+/* Points the block arrays into cik_fabrik_batch_scratch_size(n) bytes of scratch memory */
+CIK_API CIK_INLINE void cik_batch_block_init(cik_batch_block *block, int n, void *scratch)
+{
+  block->x = (float *)scratch;
+  block->y = block->x + n * CIK_BATCH_LANES;
+  block->z = block->y + n * CIK_BATCH_LANES;
+  block->lengths = block->z + n * CIK_BATCH_LANES;
+  block->rest_x = block->lengths + n * CIK_BATCH_LANES;
+  block->rest_y = block->rest_x + n * CIK_BATCH_LANES;
+  block->rest_z = block->rest_y + n * CIK_BATCH_LANES;
+  block->side_x = block->rest_z + n * CIK_BATCH_LANES;
+  block->side_y = block->side_x + n * CIK_BATCH_LANES;
+  block->side_z = block->side_y + n * CIK_BATCH_LANES;
+  block->limits = block->side_z + n * CIK_BATCH_LANES;
+  block->planar = block->limits + 4 * n;
+  block->iterations_run = 0;
+  block->lane_iterations_run = 0;
+}
+
+/* Loads the chain in slot "slot" of the solve order into lane l with the settings of its
+ * tier, a negative slot leaves the lane empty (zero and inactive)
+ */
+CIK_API CIK_INLINE void cik_fabrik_batch_gather(cik_fabrik_batch *batch, cik_batch_block *block, int l, int slot)
+{
+  int n = batch->n;
+  int count = batch->count;
+  int used = slot >= 0;
+  int k = used ? (batch->order ? batch->order[slot] : slot) : 0;
+  cik_fabrik_lod *lod;
+  int i;
+
+  block->chain[l] = used ? k : -1;
+  block->tier[l] = (used && batch->importance) ? cik_fabrik_lod_tier(batch->importance[k]) : CIK_LOD_TIERS;
+  lod = &batch->lod[block->tier[l]];
+
+  for (i = 0; i < n; ++i)
+  {
+    block->x[i * CIK_BATCH_LANES + l] = used ? batch->x[i * count + k] : 0.0f;
+    block->y[i * CIK_BATCH_LANES + l] = used ? batch->y[i * count + k] : 0.0f;
+    block->z[i * CIK_BATCH_LANES + l] = used ? batch->z[i * count + k] : 0.0f;
+  }
+
+  block->target_x[l] = used ? batch->target_x[k] : 0.0f;
+  block->target_y[l] = used ? batch->target_y[k] : 0.0f;
+  block->target_z[l] = used ? batch->target_z[k] : 0.0f;
+  block->tolerance[l] = lod->tolerance;
+  block->iterations[l] = (float)lod->max_iter;
+  block->constrain[l] = (float)lod->constrain;
+  block->active[l] = used ? 1.0f : 0.0f;
+  block->result[l] = 2;
+}
+
+/* Writes pose and result of the chain in lane l back to the batch */
+CIK_API CIK_INLINE void cik_fabrik_batch_scatter(cik_fabrik_batch *batch, cik_batch_block *block, int l)
+{
+  int n = batch->n;
+  int count = batch->count;
+  int k = block->chain[l];
+  int i;
+
+  for (i = 0; i < n; ++i)
+  {
+    batch->x[i * count + k] = block->x[i * CIK_BATCH_LANES + l];
+    batch->y[i * count + k] = block->y[i * CIK_BATCH_LANES + l];
+    batch->z[i * count + k] = block->z[i * CIK_BATCH_LANES + l];
+  }
+
+  batch->result[k] = block->result[l];
+
+  /* Remember settled solves, lanes with result 1 are solved again next time */
+  if (batch->history)
+  {
+    float *h = batch->history + k * CIK_FABRIK_BATCH_HISTORY_FLOATS;
+    int e = (n - 1) * CIK_BATCH_LANES + l;
+
+    h[CIK_FABRIK_HISTORY_TARGET + 0] = block->target_x[l];
+    h[CIK_FABRIK_HISTORY_TARGET + 1] = block->target_y[l];
+    h[CIK_FABRIK_HISTORY_TARGET + 2] = block->target_z[l];
+    h[CIK_FABRIK_HISTORY_ROOT + 0] = block->x[l];
+    h[CIK_FABRIK_HISTORY_ROOT + 1] = block->y[l];
+    h[CIK_FABRIK_HISTORY_ROOT + 2] = block->z[l];
+    h[CIK_FABRIK_HISTORY_END + 0] = block->x[e];
+    h[CIK_FABRIK_HISTORY_END + 1] = block->y[e];
+    h[CIK_FABRIK_HISTORY_END + 2] = block->z[e];
+    h[CIK_FABRIK_HISTORY_RESULT] = block->result[l] != 1 ? (float)block->result[l] : -1.0f;
+    h[CIK_FABRIK_HISTORY_TIER] = (float)block->tier[l];
+    h[CIK_FABRIK_HISTORY_TOLERANCE] = block->tolerance[l];
+  }
+}
+
+/* Solves the chains [c, c + CIK_BATCH_LANES) of the solve order in one block, each at the
+ * detail of its importance. A chain's result only depends on its own lane, so blocks can be
+ * solved in any order.
+ */
+CIK_API CIK_INLINE void cik_fabrik_batch_solve_block(cik_fabrik_batch *batch, cik_batch_block *block, int c)
+{
+  int lanes = (batch->solved - c < CIK_BATCH_LANES) ? (batch->solved - c) : CIK_BATCH_LANES;
+  int l;
+
+  /* Gather the chains into the block, unused lanes are zero and stay inactive */
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    cik_fabrik_batch_gather(batch, block, l, l < lanes ? c + l : -1);
+  }
+
+  cik_fabrik_batch_block_solve(
+      block, batch->n, batch->max_angle, batch->hinge_type, batch->hinge_axis,
+      batch->hinge_min, batch->hinge_max);
+
+  /* Scatter the results back */
+  for (l = 0; l < lanes; ++l)
+  {
+    cik_fabrik_batch_scatter(batch, block, l);
+  }
+}
+
+/* Solves the slots [begin, end) of the solve order as a stream through one block. Whenever
+ * a lane finishes (converged, stalled, out of iterations or taken out by
+ * cik_fabrik_batch_lane_begin) its chain is written back and the lane is refilled with the
+ * next pending chain, so the block keeps iterating full instead of waiting for its slowest
+ * lane. Every chain runs the same operations as in cik_fabrik_batch_solve_block.
+ */
+CIK_API CIK_INLINE void cik_fabrik_batch_solve_stream(cik_fabrik_batch *batch, cik_batch_block *block, int begin, int end)
+{
+  int next = begin;
+  int l;
+
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    cik_fabrik_batch_gather(batch, block, l, next < end ? next++ : -1);
+    cik_fabrik_batch_lane_begin(block, l, batch->n, batch->max_angle, batch->hinge_type, batch->hinge_axis, batch->hinge_min, batch->hinge_max);
+  }
+
+  for (;;)
+  {
+    /* Retire finished lanes and refill them from the queue */
+    for (l = 0; l < CIK_BATCH_LANES; ++l)
+    {
+      while (block->chain[l] >= 0 && block->active[l] == 0.0f)
+      {
+        cik_fabrik_batch_scatter(batch, block, l);
+        cik_fabrik_batch_gather(batch, block, l, next < end ? next++ : -1);
+        cik_fabrik_batch_lane_begin(block, l, batch->n, batch->max_angle, batch->hinge_type, batch->hinge_axis, batch->hinge_min, batch->hinge_max);
+      }
+    }
+
+    if (cik_fabrik_batch_block_step(block, batch->n, batch->hinge_type, batch->hinge_min, batch->hinge_max))
+    {
+      break;
+    }
+  }
+}
+
+/* Fills the batch arguments, returns 0 and sets every result to 2 on invalid input */
+CIK_API CIK_INLINE int cik_fabrik_batch_init(
+    cik_fabrik_batch *batch,
+    float *x, float *y, float *z, int n, int count,
+    float *target_x, float *target_y, float *target_z,
+    float *max_angle, int *hinge_type, v3 *hinge_axis, float *hinge_min, float *hinge_max,
+    float tolerance, int max_iter, int *result, void *scratch)
+{
+  int c;
+
+  batch->x = x;
+  batch->y = y;
+  batch->z = z;
+  batch->n = n;
+  batch->count = count;
+  batch->target_x = target_x;
+  batch->target_y = target_y;
+  batch->target_z = target_z;
+  batch->max_angle = max_angle;
+  batch->hinge_type = hinge_type;
+  batch->hinge_axis = hinge_axis;
+  batch->hinge_min = hinge_min;
+  batch->hinge_max = hinge_max;
+  batch->tolerance = tolerance;
+  batch->max_iter = max_iter;
+  batch->result = result;
+  batch->importance = 0;
+  batch->history = 0;
+  batch->order = 0;
+  batch->solved = count;
+
+  for (c = 0; c <= CIK_LOD_TIERS; ++c)
+  {
+    batch->lod[c] = cik_fabrik_lod_policy(c, tolerance, max_iter);
+  }
+
+  if (n < 2 || !scratch)
+  {
+    for (c = 0; c < count; ++c)
+    {
+      result[c] = 2;
+    }
+
+    return 0;
+  }
+
+  return 1;
+}
+
+CIK_API CIK_INLINE void cik_fabrik_solve_batch_scratch(
+    float *x,         /* [n * count] joint x positions (in/out) */
+    float *y,         /* [n * count] joint y positions (in/out) */
+    float *z,         /* [n * count] joint z positions (in/out) */
+    int n,            /* number of joints per chain */
+    int count,        /* number of chains */
+    float *target_x,  /* [count] target x positions */
+    float *target_y,  /* [count] target y positions */
+    float *target_z,  /* [count] target z positions */
+    float *max_angle, /* spherical limits [n-1], shared by all chains */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge, shared by all chains */
+    v3 *hinge_axis,   /* hinge axes, shared by all chains */
+    float *hinge_min, /* hinge min angles, shared by all chains */
+    float *hinge_max, /* hinge max angles, shared by all chains */
+    float tolerance,
+    int max_iter,
+    int *result,  /* [count] per chain return code, see cik_fabrik_solve */
+    void *scratch /* cik_fabrik_batch_scratch_size(n) bytes, aligned for float */
+)
+{
+  cik_fabrik_batch batch;
+  cik_batch_block block;
+
+  if (!cik_fabrik_batch_init(
+          &batch, x, y, z, n, count, target_x, target_y, target_z,
+          max_angle, hinge_type, hinge_axis, hinge_min, hinge_max,
+          tolerance, max_iter, result, scratch))
+  {
+    return;
+  }
+
+  cik_batch_block_init(&block, n, scratch);
+  cik_fabrik_batch_solve_stream(&batch, &block, 0, count);
+}
+
+/* Tier chain c is solved at, 0 if it is not solved (importance 0 or idle, see
+ * cik_fabrik_solve_batch_lod). Sets the result of chains that are not solved.
+ */
+CIK_API CIK_INLINE int cik_fabrik_batch_tier(cik_fabrik_batch *batch, int c)
+{
+  int tier = batch->importance ? cik_fabrik_lod_tier(batch->importance[c]) : CIK_LOD_TIERS;
+
+  if (tier == 0)
+  {
+    batch->result[c] = 1;
+  }
+  else if (batch->history && cik_fabrik_batch_idle(batch->history, batch->x, batch->y, batch->z, batch->n, batch->count, c, batch->target_x[c], batch->target_y[c], batch->target_z[c], tier, batch->lod[tier].tolerance))
+  {
+    batch->result[c] = (int)batch->history[c * CIK_FABRIK_BATCH_HISTORY_FLOATS + CIK_FABRIK_HISTORY_RESULT];
+    tier = 0;
+  }
+
+  return tier;
+}
+
+/* Scratch memory for cik_fabrik_solve_batch_lod: the block and the solve order of count chains */
+CIK_API CIK_INLINE unsigned long cik_fabrik_batch_lod_scratch_size(int n, int count)
+{
+  return n < 2 ? 0 : cik_fabrik_batch_scratch_size(n) + (unsigned long)(count < 0 ? 0 : count) * (unsigned long)sizeof(int);
+}
+
+/* cik_fabrik_solve_batch_scratch with a level of detail per chain (see cik_fabrik_lod) and
+ * dirty tracking (see cik_fabrik_batch_history_reset). The chains are solved sorted by tier,
+ * so blocks mostly hold chains with the same iteration count and blocks that skip the joint
+ * limits skip the constraint math entirely. Chains with importance 0 cost nothing, keep their
+ * pose and report 1, idle chains keep their pose and report their last result. Both are
+ * compacted out of the solve order, so the blocks stay full of chains that need work. Total
+ * cost follows the importance and motion of the chains rather than their number. Chains at
+ * full importance match cik_fabrik_solve_batch_scratch exactly.
+ */
+CIK_API CIK_INLINE void cik_fabrik_solve_batch_lod(
+    float *x,          /* [n * count] joint x positions (in/out) */
+    float *y,          /* [n * count] joint y positions (in/out) */
+    float *z,          /* [n * count] joint z positions (in/out) */
+    int n,             /* number of joints per chain */
+    int count,         /* number of chains */
+    float *target_x,   /* [count] target x positions */
+    float *target_y,   /* [count] target y positions */
+    float *target_z,   /* [count] target z positions */
+    float *max_angle,  /* spherical limits [n-1], shared by all chains */
+    int *hinge_type,   /* 0 = spherical, 1 = hinge, shared by all chains */
+    v3 *hinge_axis,    /* hinge axes, shared by all chains */
+    float *hinge_min,  /* hinge min angles, shared by all chains */
+    float *hinge_max,  /* hinge max angles, shared by all chains */
+    float tolerance,   /* tolerance at full detail */
+    int max_iter,      /* iteration cap at full detail */
+    float *importance, /* [count] per chain importance in [0, 1] (see cik_lod_importance), 0 = all at full detail */
+    float *history,    /* [CIK_FABRIK_BATCH_HISTORY_FLOATS * count] settled solves kept across calls, 0 = solve every chain */
+    int *result,       /* [count] per chain return code, see cik_fabrik_solve */
+    void *scratch      /* cik_fabrik_batch_lod_scratch_size(n, count) bytes, aligned for float */
+)
+{
+  cik_fabrik_batch batch;
+  cik_batch_block block;
+  int start[CIK_LOD_TIERS + 1];
+  int c, t;
+
+  if (!cik_fabrik_batch_init(
+          &batch, x, y, z, n, count, target_x, target_y, target_z,
+          max_angle, hinge_type, hinge_axis, hinge_min, hinge_max,
+          tolerance, max_iter, result, scratch))
+  {
+    return;
+  }
+
+  batch.importance = importance;
+  batch.history = history;
+  batch.order = (int *)((float *)scratch + CIK_FABRIK_BATCH_SCRATCH_FLOATS(n));
+  batch.solved = 0;
+
+  /* Counting sort by tier, full detail first. Tier 0 and idle chains are left out. */
+  for (t = 0; t <= CIK_LOD_TIERS; ++t)
+  {
+    start[t] = 0;
+  }
+
+  for (c = 0; c < count; ++c)
+  {
+    start[cik_fabrik_batch_tier(&batch, c)]++;
+  }
+
+  for (t = CIK_LOD_TIERS; t > 0; --t)
+  {
+    int tier_count = start[t];
+
+    start[t] = batch.solved;
+    batch.solved += tier_count;
+  }
+
+  for (c = 0; c < count; ++c)
+  {
+    t = cik_fabrik_batch_tier(&batch, c);
+
+    if (t > 0)
+    {
+      batch.order[start[t]++] = c;
+    }
+  }
+
+  cik_batch_block_init(&block, n, scratch);
+  cik_fabrik_batch_solve_stream(&batch, &block, 0, batch.solved);
+}
+
+/* Solves one chain from several initial poses side by side in the batch lanes and keeps the
+ * best. Start 0 is the given pose, start k turns the joints around the line from the root to
+ * the target by +-(k + 1) / 2 * 360 / starts degrees (alternating sign), which flips or
+ * rotates the fold the chain is bent into. The solve ends once any start converges and keeps
+ * the converged start closest to the given pose, or else the start with the smallest error.
+ * The constraints are measured against the given pose like in cik_fabrik_solve.
+ *
+ * Every iteration is one batch block iteration whatever the number of starts, so this trades
+ * latency for success rate and is not as fast as a single solve. With the lane loops
+ * vectorized (GCC -O3 -fno-trapping-math, see the batch solver) it takes about 3 to 5 times a
+ * single cik_fabrik_solve on 4 to 8 joint constrained chains, more in builds where they stay
+ * scalar. Where one retry from a flipped pose is enough it is the cheaper choice, cik_bench
+ * prints both.
+ *
+ * 0 = converged within tolerance
+ * 1 = max_iter reached or stalled in every start (the best start is kept)
+ * 2 = invalid input (n < 2, starts outside 1..CIK_BATCH_LANES, no scratch memory or degenerate lengths)
+ * 3 = target unreachable, clamped at max reach
+ * 4 = target inside the minimum reach (longest bone minus the others), pose unchanged
+ */
+CIK_API CIK_INLINE int cik_fabrik_solve_multistart(
+    v3 *pos,          /* [n] joint positions (in/out) */
+    int n,            /* number of joints */
+    v3 target,        /* target position */
+    float *max_angle, /* spherical limits [n-1] */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge */
+    v3 *hinge_axis,   /* hinge axes */
+    float *hinge_min, /* hinge min angles */
+    float *hinge_max, /* hinge max angles */
+    float tolerance,
+    int max_iter,
+    int starts,   /* initial poses solved side by side, 1 to CIK_BATCH_LANES */
+    void *scratch /* cik_fabrik_batch_scratch_size(n) bytes, aligned for float */
+)
+{
+  cik_batch_block block;
+  v3 axis = cik_v3_sub(target, pos[0]);
+  int best = 0;
+  int i, l;
+
+  if (n < 2 || !scratch || starts < 1 || starts > CIK_BATCH_LANES)
+  {
+    return 2;
+  }
+
+  cik_batch_block_init(&block, n, scratch);
+
+  /* Every start begins from the given pose so the constraints compile against it */
+  for (l = 0; l < CIK_BATCH_LANES; ++l)
+  {
+    int used = l < starts;
+
+    for (i = 0; i < n; ++i)
+    {
+      block.x[i * CIK_BATCH_LANES + l] = used ? pos[i].x : 0.0f;
+      block.y[i * CIK_BATCH_LANES + l] = used ? pos[i].y : 0.0f;
+      block.z[i * CIK_BATCH_LANES + l] = used ? pos[i].z : 0.0f;
+    }
+
+    block.target_x[l] = used ? target.x : 0.0f;
+    block.target_y[l] = used ? target.y : 0.0f;
+    block.target_z[l] = used ? target.z : 0.0f;
+    block.tolerance[l] = tolerance;
+    block.iterations[l] = (float)max_iter;
+    block.constrain[l] = 1.0f;
+    block.active[l] = used ? 1.0f : 0.0f;
+    block.result[l] = 2;
+  }
+
+  cik_fabrik_batch_block_begin(&block, n, max_angle, hinge_type, hinge_axis, hinge_min, hinge_max);
+
+  /* Turn the other starts around the root to target line (Rodrigues rotation) */
+  if (block.active[0] > 0.0f && cik_v3_length_2(axis) > 1e-12f)
+  {
+    axis = cik_v3_normalize(axis);
+
+    for (l = 1; l < starts; ++l)
+    {
+      float angle = (float)((l + 1) / 2) * CIK_PI_DOUBLED / (float)starts * ((l & 1) ? 1.0f : -1.0f);
+      float s, c;
+
+      cik_sincosf_precise(angle, &s, &c);
+
+      for (i = 1; i < n; ++i)
+      {
+        int k = i * CIK_BATCH_LANES + l;
+        v3 v = cik_v3_sub(pos[i], pos[0]);
+        v3 r = cik_v3_add(cik_v3_add(cik_v3_scale(v, c), cik_v3_scale(cik_v3_cross(axis, v), s)), cik_v3_scale(axis, cik_v3_dot(axis, v) * (1.0f - c)));
+
+        block.x[k] = pos[0].x + r.x;
+        block.y[k] = pos[0].y + r.y;
+        block.z[k] = pos[0].z + r.z;
+      }
+    }
+  }
+
+  for (;;)
+  {
+    int converged = 0;
+
+    if (cik_fabrik_batch_block_step(&block, n, hinge_type, hinge_min, hinge_max))
+    {
+      break;
+    }
+
+    for (l = 0; l < starts; ++l)
+    {
+      converged |= block.result[l] == 0;
+    }
+
+    if (converged)
+    {
+      break;
+    }
+  }
+
+  /* First converged start, otherwise the smallest error */
+  for (l = 1; l < starts; ++l)
+  {
+    if (block.result[best] != 0 && (block.result[l] == 0 || block.error_2[l] < block.error_2[best]))
+    {
+      best = l;
+    }
+  }
+
+  for (i = 0; i < n; ++i)
+  {
+    pos[i] = cik_v3(block.x[i * CIK_BATCH_LANES + best], block.y[i * CIK_BATCH_LANES + best], block.z[i * CIK_BATCH_LANES + best]);
+  }
+
+  return block.result[best];
+}
+
+/* Batch solve with the block storage on the stack (chains of more than CIK_MAX_JOINTS are
+ * invalid input), see cik_fabrik_solve_batch_scratch to reuse one allocation across calls.
+ */
+CIK_API CIK_INLINE void cik_fabrik_solve_batch(
+    float *x,         /* [n * count] joint x positions (in/out) */
+    float *y,         /* [n * count] joint y positions (in/out) */
+    float *z,         /* [n * count] joint z positions (in/out) */
+    int n,            /* number of joints per chain */
+    int count,        /* number of chains */
+    float *target_x,  /* [count] target x positions */
+    float *target_y,  /* [count] target y positions */
+    float *target_z,  /* [count] target z positions */
+    float *max_angle, /* spherical limits [n-1], shared by all chains */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge, shared by all chains */
+    v3 *hinge_axis,   /* hinge axes, shared by all chains */
+    float *hinge_min, /* hinge min angles, shared by all chains */
+    float *hinge_max, /* hinge max angles, shared by all chains */
+    float tolerance,
+    int max_iter,
+    int *result /* [count] per chain return code, see cik_fabrik_solve */
+)
+{
+  float scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+  cik_fabrik_solve_batch_scratch(
+      x, y, z, n, count, target_x, target_y, target_z,
+      max_angle, hinge_type, hinge_axis, hinge_min, hinge_max,
+      tolerance, max_iter, result, n > CIK_MAX_JOINTS ? 0 : scratch);
+}
+
+/* ---------------------- FABRIK Threaded Batch Solver ---------------------- */
+/* Define CIK_THREADS to split a batch across worker threads. Linux uses pthreads (includes
+ * pthread.h, link with -pthread) and Win32 uses CreateThread, declared here instead of pulling
+ * in windows.h. Other platforms solve the whole batch on the calling thread.
+ *
+ * Every worker owns an equal range of blocks and claims them one at a time from the front of
+ * its range through an atomic counter. Blocks are solved whole (cik_fabrik_batch_solve_block)
+ * so any worker can take any block: one that runs out steals from the ranges of the others
+ * through the same counters. Chains are always grouped into the same blocks, so every chain's
+ * result is bit-identical for any thread count.
+ */
+#ifdef CIK_THREADS
+
+#ifndef CIK_THREADS_MAX
+#define CIK_THREADS_MAX 64
+#endif
+
+#if defined(_MSC_VER)
+long _InterlockedExchangeAdd(long volatile *addend, long value);
+#pragma intrinsic(_InterlockedExchangeAdd)
+#define CIK_ATOMIC_FETCH_ADD(p, v) _InterlockedExchangeAdd((p), (v))
+#else
+#define CIK_ATOMIC_FETCH_ADD(p, v) __sync_fetch_and_add((p), (v))
+#endif
+
+#ifdef _WIN32
+#define CIK_THREAD_RETURN unsigned long __stdcall
+#define CIK_WIN32_INFINITE 0xFFFFFFFFUL
+typedef void *cik_thread;
+
+/* Because windows.h is massivly bloated and increases compilation time a lot we declare only the function we really need */
+#ifndef _WINDOWS_
+#define CIK_WIN32_API(r) __declspec(dllimport) r __stdcall
+
+CIK_WIN32_API(void *)
+CreateThread(void *lpThreadAttributes, unsigned long dwStackSize, unsigned long(__stdcall *lpStartAddress)(void *), void *lpParameter, unsigned long dwCreationFlags, unsigned long *lpThreadId);
+
+CIK_WIN32_API(unsigned long)
+WaitForSingleObject(void *hHandle, unsigned long dwMilliseconds);
+
+CIK_WIN32_API(int)
+CloseHandle(void *hObject);
+
+#endif /* _WINDOWS_ */
+#elif defined(__linux__)
+#include <pthread.h>
+#define CIK_THREAD_RETURN void *
+typedef pthread_t cik_thread;
+#else
+#define CIK_THREAD_RETURN void *
+typedef int cik_thread;
+#endif
+
+typedef struct cik_thread_worker
+{
+  cik_fabrik_batch *batch;
+  struct cik_thread_worker *workers;
+  int worker_count;
+  int index;
+  long volatile next; /* next block of the own range, advanced by the owner and by thieves */
+  long end;
+  cik_batch_block block;
+
+} cik_thread_worker;
+
+/* Solves blocks from the own range first, then steals from the others */
+CIK_API CIK_INLINE void cik_thread_worker_run(cik_thread_worker *worker)
+{
+  int v;
+
+  for (v = 0; v < worker->worker_count; ++v)
+  {
+    cik_thread_worker *victim = &worker->workers[(worker->index + v) % worker->worker_count];
+    long b;
+
+    while ((b = CIK_ATOMIC_FETCH_ADD(&victim->next, 1L)) < victim->end)
+    {
+      cik_fabrik_batch_solve_block(worker->batch, &worker->block, (int)b * CIK_BATCH_LANES);
+    }
+  }
+}
+
+CIK_API CIK_INLINE CIK_THREAD_RETURN cik_thread_worker_entry(void *worker)
+{
+  cik_thread_worker_run((cik_thread_worker *)worker);
+  return 0;
+}
+
+/* Returns 1 if the worker thread was started. On failure its range is stolen by the others. */
+CIK_API CIK_INLINE int cik_thread_start(cik_thread *thread, cik_thread_worker *worker)
+{
+#ifdef _WIN32
+  *thread = CreateThread(0, 0, cik_thread_worker_entry, worker, 0, 0);
+  return *thread != 0;
+#elif defined(__linux__)
+  return pthread_create(thread, 0, cik_thread_worker_entry, worker) == 0;
+#else
+  (void)thread;
+  (void)worker;
+  return 0;
+#endif
+}
+
+CIK_API CIK_INLINE void cik_thread_join(cik_thread thread)
+{
+#ifdef _WIN32
+  WaitForSingleObject(thread, CIK_WIN32_INFINITE);
+  CloseHandle(thread);
+#elif defined(__linux__)
+  pthread_join(thread, 0);
+#else
+  (void)thread;
+#endif
+}
+
+/* Scratch memory for the threaded batch solver, one block per thread */
+CIK_API CIK_INLINE unsigned long cik_fabrik_batch_threaded_scratch_size(int n, int threads)
+{
+  threads = threads < 1 ? 1 : (threads > CIK_THREADS_MAX ? CIK_THREADS_MAX : threads);
+  return cik_fabrik_batch_scratch_size(n) * (unsigned long)threads;
+}
+
+/* cik_fabrik_solve_batch_scratch on up to "threads" threads (the calling thread included).
+ * The results are identical to the single threaded batch solver.
+ */
+CIK_API CIK_INLINE void cik_fabrik_solve_batch_threaded(
+    float *x,         /* [n * count] joint x positions (in/out) */
+    float *y,         /* [n * count] joint y positions (in/out) */
+    float *z,         /* [n * count] joint z positions (in/out) */
+    int n,            /* number of joints per chain */
+    int count,        /* number of chains */
+    float *target_x,  /* [count] target x positions */
+    float *target_y,  /* [count] target y positions */
+    float *target_z,  /* [count] target z positions */
+    float *max_angle, /* spherical limits [n-1], shared by all chains */
+    int *hinge_type,  /* 0 = spherical, 1 = hinge, shared by all chains */
+    v3 *hinge_axis,   /* hinge axes, shared by all chains */
+    float *hinge_min, /* hinge min angles, shared by all chains */
+    float *hinge_max, /* hinge max angles, shared by all chains */
+    float tolerance,
+    int max_iter,
+    int *result,  /* [count] per chain return code, see cik_fabrik_solve */
+    int threads,  /* number of threads, clamped to [1, CIK_THREADS_MAX] */
+    void *scratch /* cik_fabrik_batch_threaded_scratch_size(n, threads) bytes, aligned for float */
+)
+{
+  cik_fabrik_batch batch;
+  cik_thread_worker workers[CIK_THREADS_MAX];
+  cik_thread handles[CIK_THREADS_MAX];
+  int started[CIK_THREADS_MAX];
+  long blocks = (long)((count + CIK_BATCH_LANES - 1) / CIK_BATCH_LANES);
+  int t;
+
+  if (!cik_fabrik_batch_init(
+          &batch, x, y, z, n, count, target_x, target_y, target_z,
+          max_angle, hinge_type, hinge_axis, hinge_min, hinge_max,
+          tolerance, max_iter, result, scratch))
+  {
+    return;
+  }
+
+  threads = threads < 1 ? 1 : (threads > CIK_THREADS_MAX ? CIK_THREADS_MAX : threads);
+  threads = (long)threads > blocks ? (int)blocks : threads;
+
+  for (t = 0; t < threads; ++t)
+  {
+    workers[t].batch = &batch;
+    workers[t].workers = workers;
+    workers[t].worker_count = threads;
+    workers[t].index = t;
+    workers[t].next = blocks * t / threads;
+    workers[t].end = blocks * (t + 1) / threads;
+
+    cik_batch_block_init(&workers[t].block, n, (float *)scratch + t * CIK_FABRIK_BATCH_SCRATCH_FLOATS(n));
+  }
+
+  /* Worker 0 is the calling thread */
+  for (t = 1; t < threads; ++t)
+  {
+    started[t] = cik_thread_start(&handles[t], &workers[t]);
+  }
+
+  if (threads > 0)
+  {
+    cik_thread_worker_run(&workers[0]);
+  }
+
+  for (t = 1; t < threads; ++t)
+  {
+    if (started[t])
+    {
+      cik_thread_join(handles[t]);
+    }
+  }
+}
+
+#endif /* CIK_THREADS */
+
 #endif /* CIK_H */
 
 /*
@@ -138,7 +138,8 @@ PERF_API PERF_INLINE void perf_platform_print(char *str)
 #define _GNU_SOURCE
 #endif
 
-#ifndef __timespec_defined
+/* glibc guards its own definition with _STRUCT_TIMESPEC */
+#if !defined(__timespec_defined) && !defined(_STRUCT_TIMESPEC)
 #define __timespec_defined
 struct timespec
 {
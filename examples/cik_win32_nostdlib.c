@@ -250,8 +250,13 @@ static void run_fabrik_arm(csr_context *context, pmem *memory_io)
           max_iterations /* max iterations */
       );
 
-      /* Target unreachable */
-      if (solved == 3)
+      /* Target inside the minimum reach or unreachable */
+      if (solved == 4)
+      {
+        pio_print("[cik][fabrik][arm] target inside the minimum reach, pose unchanged\n");
+        break;
+      }
+      else if (solved == 3)
       {
         pio_print("[cik][fabrik][arm] target unreachable, clamped at max reach\n");
         break;
@@ -505,8 +510,13 @@ static void run_fabrik_mesh_builder(csr_context *context, pmem *memory_io)
           max_iterations /* max iterations */
       );
 
-      /* Target unreachable */
-      if (solved == 3)
+      /* Target inside the minimum reach or unreachable */
+      if (solved == 4)
+      {
+        pio_print("[cik][fabrik][mesh] target inside the minimum reach, pose unchanged\n");
+        break;
+      }
+      else if (solved == 3)
       {
         pio_print("[cik][fabrik][mesh] target unreachable, clamped at max reach\n");
         break;
@@ -718,8 +728,13 @@ static void run_fabrik_excavator(csr_context *context, pmem *memory_io)
           12         /* Max iterations */
       );
 
-      /* Target unreachable */
-      if (solved == 3)
+      /* Target inside the minimum reach or unreachable */
+      if (solved == 4)
+      {
+        pio_print("[cik][fabrik][excavator] target inside the minimum reach, pose unchanged\n");
+        break;
+      }
+      else if (solved == 3)
       {
         pio_print("[cik][fabrik][excavator] target unreachable, clamped at max reach\n");
         break;
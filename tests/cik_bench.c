@@ -0,0 +1,1587 @@
+/* cik.h - v0.2 - public domain data structures - nickscha 2025
+
+A C89 standard compliant, single header, nostdlib (no C Standard Library) Computational Inverse Kinematics (CIK).
+
+This Benchmark measures the solver over seeded scenarios so performance changes can be compared across versions:
+- chain length from 2 to 128 joints
+- all spherical, all hinge (shared axis) and mixed constraints
+- reachable, unreachable and near-singular (almost fully stretched) targets
+- static targets (every solve starts from the rest pose) and moving targets (every solve starts from the last pose)
+- thread scaling of the threaded batch solver (CIK_THREADS) from 1 to 32 threads
+- a crowd of chains seen from three cameras, solved at full detail and with cik_fabrik_solve_batch_lod
+- a crowd where 10% of the targets move per frame, solved with and without dirty tracking
+- fixed blocks against refilled lanes (cik_fabrik_batch_solve_stream) with the effective lane occupancy
+- a torso with two arms and a head solved as one tree versus chain by chain
+- FABRIK, FABRIK with momentum (CIK_FABRIK_MOMENTUM), FABRIK with constrained forward passes (CIK_FABRIK_CONSTRAIN_FORWARD),
+  CCD, DLS and the FABRIK to DLS hybrid side by side on every scenario
+- the excavator arm from the examples on a swinging turret with each FABRIK option
+- the unrolled CIK_DEFINE_FABRIK_SOLVER solvers against the generic chain solve for 3, 4 and 6 joints
+- one solve, a retry from the flipped pose and cik_fabrik_solve_multistart with 2, 4 and 8 starts on constrained chains
+- error and cost of sin, atan2 and 1/sqrt in every math tier (CIK_MATH_FAST, CIK_MATH_BALANCED, CIK_MATH_PRECISE)
+- the 1/sqrt variants over arrays: 1/sqrtf, _mm_rsqrt_ps with a Newton step, cik_invsqrt, cik_invsqrt_lanes and cik_invsqrt_soft
+
+For every scenario it reports ns/solve, iterations/solve and the convergence rate, the raw timings are
+collected with the perf.h stats and printed at the end.
+
+LICENSE
+
+  Placed in the public domain and also MIT licensed.
+  See end of file for detailed license information.
+
+*/
+#define PERF_STATS_ENABLE
+#define PERF_DISBALE_INTERMEDIATE_PRINT
+#ifndef CIK_THREADS
+#define CIK_THREADS
+#endif
+
+#include "../cik.h" /* Computational Inverse Kinematics */
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#define BENCH_X86
+#endif
+
+#include "../deps/perf.h" /* Simple Performance profiler */
+
+#include <stdio.h>
+
+#define BENCH_BLOCKS 10     /* timed blocks per scenario */
+#define BENCH_BLOCK_SOLVES 50 /* solves per timed block */
+#define BENCH_TOLERANCE 1e-3f
+#define BENCH_MAX_ITER 32
+#define BENCH_HYBRID_SWITCH 0.05f /* error at which the hybrid solver switches from FABRIK to DLS */
+#define BENCH_BATCH_JOINTS 8
+#define BENCH_BATCH_CHAINS 1024
+
+static unsigned long cik_bench_seed;
+
+/* Deterministic LCG in [0, 1) so every run uses the same scenarios */
+static float cik_bench_random(void)
+{
+  cik_bench_seed = (cik_bench_seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+  return (float)(cik_bench_seed >> 8) / (float)(0x7fffffffUL >> 8);
+}
+
+static v3 cik_bench_random_dir(int planar)
+{
+  v3 d;
+
+  do
+  {
+    d = cik_v3(cik_bench_random() * 2.0f - 1.0f, cik_bench_random() * 2.0f - 1.0f, planar ? 0.0f : cik_bench_random() * 2.0f - 1.0f);
+  } while (cik_v3_length_2(d) < 0.01f || cik_v3_length_2(d) > 1.0f);
+
+  return cik_v3_normalize(d);
+}
+
+/* Rotates the unit vector v by angle around the unit axis perpendicular to it */
+static v3 cik_bench_rotate(v3 v, v3 axis, float angle)
+{
+  return cik_v3_add(cik_v3_scale(v, cik_cosf(angle)), cik_v3_scale(cik_v3_cross(axis, v), cik_sinf(angle)));
+}
+
+typedef enum cik_bench_constraints
+{
+  CIK_BENCH_SPHERICAL = 0,
+  CIK_BENCH_HINGE,
+  CIK_BENCH_MIXED
+
+} cik_bench_constraints;
+
+typedef enum cik_bench_targets
+{
+  CIK_BENCH_REACHABLE = 0,
+  CIK_BENCH_UNREACHABLE,
+  CIK_BENCH_NEAR_SINGULAR
+
+} cik_bench_targets;
+
+typedef enum cik_bench_solvers
+{
+  CIK_BENCH_FABRIK = 0,
+  CIK_BENCH_FABRIK_MOMENTUM,
+  CIK_BENCH_FABRIK_FORWARD,
+  CIK_BENCH_CCD,
+  CIK_BENCH_DLS,
+  CIK_BENCH_HYBRID
+
+} cik_bench_solvers;
+
+static char *cik_bench_constraint_names[] = {"spherical", "hinge", "mixed"};
+static char *cik_bench_target_names[] = {"reachable", "unreachable", "near-singular"};
+static char *cik_bench_solver_names[] = {"fabrik", "fabrik+m", "fabrik+f", "ccd", "dls", "hybrid"};
+
+static v3 rest[CIK_MAX_JOINTS];
+static v3 positions[CIK_MAX_JOINTS];
+static v3 targets[BENCH_BLOCKS * BENCH_BLOCK_SOLVES];
+static float max_angles[CIK_MAX_JOINTS];
+static int hinge_types[CIK_MAX_JOINTS];
+static v3 hinge_axes[CIK_MAX_JOINTS];
+static float hinge_min[CIK_MAX_JOINTS];
+static float hinge_max[CIK_MAX_JOINTS];
+static float scratch[CIK_FABRIK_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+/* End effector of the rest pose with every bone turned by bend[i] (in [-1, 1]) of 90% of its
+ * limit, so the target is reachable without violating any constraint. Spherical bones turn
+ * around a random axis.
+ */
+static v3 cik_bench_pose_target(int n, float *bend)
+{
+  v3 end = rest[0];
+  int i;
+
+  for (i = 0; i < n - 1; ++i)
+  {
+    v3 bone = cik_v3_sub(rest[i + 1], rest[i]);
+    v3 dir = cik_v3_normalize(bone);
+
+    if (hinge_types[i])
+    {
+      v3 axis = hinge_axes[i];
+      v3 proj = cik_v3_normalize(cik_v3_sub(dir, cik_v3_scale(axis, cik_v3_dot(dir, axis))));
+
+      dir = cik_bench_rotate(proj, axis, 0.9f * bend[i] * hinge_max[i]);
+    }
+    else
+    {
+      v3 axis = cik_v3_normalize(cik_v3_cross(dir, cik_bench_random_dir(0)));
+
+      dir = cik_bench_rotate(dir, axis, 0.9f * bend[i] * max_angles[i]);
+    }
+
+    end = cik_v3_add(end, cik_v3_scale(dir, cik_v3_length(bone)));
+  }
+
+  return end;
+}
+
+static void cik_bench_scenario(cik_bench_solvers solver, int n, cik_bench_constraints constraints, cik_bench_targets target_kind, int moving)
+{
+  char name[128];
+  cik_chain chain;
+  cik_solve_info info;
+  cik_dls_cache cache;
+  perf_stats_entry *entry;
+  float reach = 0.0f;
+  long iterations = 0;
+  int converged = 0;
+  int i, block, s;
+
+  cik_bench_seed = 42UL + (unsigned long)(n * 100 + (int)constraints * 10 + (int)target_kind * 2 + moving);
+
+  /* Zig-zag rest pose in the XY plane (unit bones) so no bone starts collinear */
+  for (i = 0; i < n; ++i)
+  {
+    rest[i] = cik_v3(0.9f * (float)i, (i & 1) ? 0.3f : 0.0f, 0.0f);
+  }
+
+  for (i = 0; i < n - 1; ++i)
+  {
+    int hinge = constraints == CIK_BENCH_HINGE || (constraints == CIK_BENCH_MIXED && (i & 1));
+
+    max_angles[i] = 0.8f;
+    hinge_types[i] = hinge;
+    hinge_axes[i] = (constraints == CIK_BENCH_MIXED && (i & 2)) ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -1.5f;
+    hinge_max[i] = 1.5f;
+    reach += cik_v3_length(cik_v3_sub(rest[i + 1], rest[i]));
+  }
+
+  /* Reachable targets come from valid poses, near-singular ones are almost at full reach
+   * close to the rest direction, hinge chains keep their targets in the hinge plane.
+   */
+  for (s = 0; s < BENCH_BLOCKS * BENCH_BLOCK_SOLVES; ++s)
+  {
+    int planar = constraints == CIK_BENCH_HINGE;
+    float bend[CIK_MAX_JOINTS];
+    v3 z_axis = cik_v3(0.0f, 0.0f, 1.0f);
+
+    for (i = 0; i < n - 1; ++i)
+    {
+      /* Moving targets follow a smooth path through valid poses */
+      bend[i] = moving ? cik_sinf(0.02f * (float)s + 1.3f * (float)i) : 2.0f * cik_bench_random() - 1.0f;
+    }
+
+    if (target_kind == CIK_BENCH_REACHABLE)
+    {
+      targets[s] = cik_bench_pose_target(n, bend);
+    }
+    else if (target_kind == CIK_BENCH_UNREACHABLE)
+    {
+      v3 dir = moving ? cik_v3_normalize(cik_v3_sub(cik_bench_pose_target(n, bend), rest[0])) : cik_bench_random_dir(planar);
+      float scale = moving ? 1.5f : 1.1f + 0.9f * cik_bench_random();
+
+      targets[s] = cik_v3_add(rest[0], cik_v3_scale(dir, reach * scale));
+    }
+    else
+    {
+      v3 axis = planar ? z_axis : cik_v3_normalize(cik_v3_cross(cik_v3(1.0f, 0.0f, 0.0f), cik_bench_random_dir(0)));
+      float angle = moving ? 0.25f * cik_sinf(0.02f * (float)s) : 0.25f * (2.0f * cik_bench_random() - 1.0f);
+      float scale = moving ? 0.995f : 0.99f + 0.009f * cik_bench_random();
+
+      targets[s] = cik_v3_add(rest[0], cik_v3_scale(cik_bench_rotate(cik_v3(1.0f, 0.0f, 0.0f), axis, angle), reach * scale));
+    }
+  }
+
+  for (i = 0; i < n; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  if (cik_chain_init(&chain, scratch, rest, n, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) != 0)
+  {
+    printf("[cik][bench] invalid scenario\n");
+    return;
+  }
+
+  chain.flags = solver == CIK_BENCH_FABRIK_MOMENTUM ? CIK_FABRIK_MOMENTUM : (solver == CIK_BENCH_FABRIK_FORWARD ? CIK_FABRIK_CONSTRAIN_FORWARD : 0);
+
+  sprintf(name, "%-8s n=%3d %-9s %-13s %s", cik_bench_solver_names[solver], n, cik_bench_constraint_names[constraints], cik_bench_target_names[target_kind], moving ? "moving" : "static");
+
+  info.trajectory = 0;
+  cik_dls_cache_reset(&cache);
+
+  for (block = 0; block < BENCH_BLOCKS; ++block)
+  {
+    int block_iterations = 0;
+    int block_converged = 0;
+
+    PERF_PROFILE_WITH_NAME({
+      for (s = block * BENCH_BLOCK_SOLVES; s < (block + 1) * BENCH_BLOCK_SOLVES; ++s)
+      {
+        if (!moving)
+        {
+          for (i = 0; i < n; ++i)
+          {
+            positions[i] = rest[i];
+          }
+        }
+
+        /* Full reach targets report unreachable, so count by the end effector error */
+        if (solver == CIK_BENCH_CCD)
+        {
+          cik_chain_solve_ccd_ex(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER, &info);
+        }
+        else if (solver == CIK_BENCH_DLS)
+        {
+          cik_chain_solve_dls_ex(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER, &cache, &info);
+        }
+        else if (solver == CIK_BENCH_HYBRID)
+        {
+          cik_chain_solve_hybrid_ex(&chain, positions, targets[s], BENCH_HYBRID_SWITCH, BENCH_TOLERANCE, BENCH_MAX_ITER, &cache, &info);
+        }
+        else
+        {
+          cik_chain_solve_ex(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER, &info);
+        }
+        block_converged += info.error <= BENCH_TOLERANCE;
+        block_iterations += info.iterations;
+      } }, name);
+
+    iterations += block_iterations;
+    converged += block_converged;
+  }
+
+  /* The scenario's entry is the last one created */
+  entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+  printf("[cik][bench] %s | %10.1f ns/solve | %6.2f iterations/solve | %6.1f%% converged\n",
+         name,
+         entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+         (double)iterations / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+         100.0 * (double)converged / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES));
+}
+
+static float batch_start[3][BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS];
+static float batch_single[3][BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS];
+static float batch_threaded[3][BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS];
+static float batch_targets[3][BENCH_BATCH_CHAINS];
+static int batch_results[BENCH_BATCH_CHAINS];
+static float batch_scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(BENCH_BATCH_JOINTS) * CIK_THREADS_MAX];
+
+/* Solves the same batch of spherical chains with 1 to 32 threads, reports ns/chain, the speedup
+ * over one thread and the number of coordinates that differ from the single threaded result
+ */
+static void cik_bench_threads(void)
+{
+  int thread_counts[] = {1, 2, 4, 8, 16, 32};
+  double single_ns = 0.0;
+  int i, c, t, k, block;
+
+  cik_bench_seed = 4242UL;
+
+  for (i = 0; i < BENCH_BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = 0.8f;
+    hinge_types[i] = 0;
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -1.5f;
+    hinge_max[i] = 1.5f;
+  }
+
+  for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+  {
+    v3 target = cik_v3_scale(cik_bench_random_dir(0), (0.2f + 0.7f * cik_bench_random()) * (float)(BENCH_BATCH_JOINTS - 1));
+
+    for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+    {
+      batch_start[0][i * BENCH_BATCH_CHAINS + c] = (float)i;
+      batch_start[1][i * BENCH_BATCH_CHAINS + c] = (i % 2) ? 0.3f : 0.0f;
+      batch_start[2][i * BENCH_BATCH_CHAINS + c] = 0.0f;
+    }
+
+    batch_targets[0][c] = target.x;
+    batch_targets[1][c] = target.y;
+    batch_targets[2][c] = target.z;
+  }
+
+  for (t = 0; t < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); ++t)
+  {
+    char name[64];
+    float(*out)[BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS] = t == 0 ? batch_single : batch_threaded;
+    perf_stats_entry *entry;
+    double ns;
+    int mismatches = 0;
+
+    sprintf(name, "batch n=%d chains=%d threads=%2d", BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS, thread_counts[t]);
+
+    for (block = 0; block < BENCH_BLOCKS; ++block)
+    {
+      for (k = 0; k < 3; ++k)
+      {
+        for (i = 0; i < BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS; ++i)
+        {
+          out[k][i] = batch_start[k][i];
+        }
+      }
+
+      PERF_PROFILE_WITH_NAME({ cik_fabrik_solve_batch_threaded(
+                                   out[0], out[1], out[2], BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS,
+                                   batch_targets[0], batch_targets[1], batch_targets[2],
+                                   max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+                                   BENCH_TOLERANCE, BENCH_MAX_ITER, batch_results, thread_counts[t], batch_scratch); }, name);
+    }
+
+    for (k = 0; k < 3; ++k)
+    {
+      for (i = 0; i < BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS; ++i)
+      {
+        mismatches += out[k][i] != batch_single[k][i];
+      }
+    }
+
+    entry = &perf_stats_entries[perf_stats_entry_count - 1];
+    ns = entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BATCH_CHAINS);
+    single_ns = t == 0 ? ns : single_ns;
+
+    printf("[cik][bench] %s | %10.1f ns/chain | %5.2fx speedup | %d mismatches\n", name, ns, single_ns / ns, mismatches);
+  }
+}
+
+#define BENCH_LOD_GRID 32 /* crowd of BENCH_LOD_GRID^2 = BENCH_BATCH_CHAINS chains */
+#define BENCH_LOD_SPACING 10.0f
+#define BENCH_LOD_FULL_DISTANCE 40.0f
+
+static float batch_importance[BENCH_BATCH_CHAINS];
+
+/* A crowd of mixed chains on a grid seen from three cameras, solved at full detail and with
+ * the importance from cik_lod_importance. The frustum test is a 90 degree view cone along +z.
+ */
+static void cik_bench_lod(void)
+{
+  char *camera_names[3] = {"near", "inside", "far"};
+  v3 cameras[3];
+  int i, c, cam, lod, k, block;
+
+  cik_bench_seed = 2323UL;
+
+  cameras[0] = cik_v3(0.5f * BENCH_LOD_SPACING * (float)BENCH_LOD_GRID, 2.0f, -20.0f);
+  cameras[1] = cik_v3(0.5f * BENCH_LOD_SPACING * (float)BENCH_LOD_GRID, 2.0f, 0.5f * BENCH_LOD_SPACING * (float)BENCH_LOD_GRID);
+  cameras[2] = cik_v3(0.5f * BENCH_LOD_SPACING * (float)BENCH_LOD_GRID, 2.0f, -600.0f);
+
+  for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+  {
+    rest[i] = cik_v3(0.9f * (float)i, (i & 1) ? 0.3f : 0.0f, 0.0f);
+  }
+
+  for (i = 0; i < BENCH_BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = 0.8f;
+    hinge_types[i] = i & 1;
+    hinge_axes[i] = (i & 2) ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -1.5f;
+    hinge_max[i] = 1.5f;
+  }
+
+  for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+  {
+    v3 base = cik_v3(BENCH_LOD_SPACING * (float)(c % BENCH_LOD_GRID), 0.0f, BENCH_LOD_SPACING * (float)(c / BENCH_LOD_GRID));
+    float bend[BENCH_BATCH_JOINTS];
+    v3 target;
+
+    for (i = 0; i < BENCH_BATCH_JOINTS - 1; ++i)
+    {
+      bend[i] = 2.0f * cik_bench_random() - 1.0f;
+    }
+
+    target = cik_v3_add(base, cik_bench_pose_target(BENCH_BATCH_JOINTS, bend));
+
+    for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+    {
+      batch_start[0][i * BENCH_BATCH_CHAINS + c] = base.x + rest[i].x;
+      batch_start[1][i * BENCH_BATCH_CHAINS + c] = base.y + rest[i].y;
+      batch_start[2][i * BENCH_BATCH_CHAINS + c] = base.z + rest[i].z;
+    }
+
+    batch_targets[0][c] = target.x;
+    batch_targets[1][c] = target.y;
+    batch_targets[2][c] = target.z;
+  }
+
+  for (cam = 0; cam < 3; ++cam)
+  {
+    int visible = 0;
+    int tiers[CIK_LOD_TIERS + 1];
+    char tier_text[64];
+    int length = 0;
+
+    for (k = 0; k <= CIK_LOD_TIERS; ++k)
+    {
+      tiers[k] = 0;
+    }
+
+    for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+    {
+      v3 center = cik_v3(BENCH_LOD_SPACING * (float)(c % BENCH_LOD_GRID), 0.0f, BENCH_LOD_SPACING * (float)(c / BENCH_LOD_GRID));
+      v3 view = cik_v3_sub(center, cameras[cam]);
+      float radius = 0.9f * (float)(BENCH_BATCH_JOINTS - 1);
+      int in_view = view.z + radius > 0.0f && (view.x < 0.0f ? -view.x : view.x) < view.z + 1.5f * radius;
+
+      batch_importance[c] = cik_lod_importance(cameras[cam], center, radius, BENCH_LOD_FULL_DISTANCE, in_view);
+      visible += in_view;
+      tiers[cik_fabrik_lod_tier(batch_importance[c])]++;
+    }
+
+    /* Chains per tier, full detail first */
+    for (k = CIK_LOD_TIERS; k > 0; --k)
+    {
+      length += sprintf(tier_text + length, k > 1 ? "%d/" : "%d", tiers[k]);
+    }
+
+    for (lod = 0; lod <= 1; ++lod)
+    {
+      char name[128];
+      perf_stats_entry *entry;
+      int converged = 0;
+
+      sprintf(name, "lod n=%d chains=%d camera=%-6s %s", BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS, camera_names[cam], lod ? "lod " : "full");
+
+      for (block = 0; block < BENCH_BLOCKS; ++block)
+      {
+        for (k = 0; k < 3; ++k)
+        {
+          for (i = 0; i < BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS; ++i)
+          {
+            batch_single[k][i] = batch_start[k][i];
+          }
+        }
+
+        PERF_PROFILE_WITH_NAME({
+          if (lod)
+          {
+            cik_fabrik_solve_batch_lod(
+                batch_single[0], batch_single[1], batch_single[2], BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS,
+                batch_targets[0], batch_targets[1], batch_targets[2],
+                max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+                BENCH_TOLERANCE, BENCH_MAX_ITER, batch_importance, 0, batch_results, batch_scratch);
+          }
+          else
+          {
+            cik_fabrik_solve_batch_scratch(
+                batch_single[0], batch_single[1], batch_single[2], BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS,
+                batch_targets[0], batch_targets[1], batch_targets[2],
+                max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+                BENCH_TOLERANCE, BENCH_MAX_ITER, batch_results, batch_scratch);
+          } }, name);
+      }
+
+      /* Convergence of the visible chains, at their own tolerance */
+      for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+      {
+        converged += batch_importance[c] > 0.0f && batch_results[c] == 0;
+      }
+
+      entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+      printf("[cik][bench] %s | %10.1f ns/chain | %4d visible (tiers %s) | %5.1f%% converged\n",
+             name,
+             entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BATCH_CHAINS),
+             visible, tier_text,
+             visible ? 100.0 * (double)converged / (double)visible : 0.0);
+    }
+  }
+}
+
+#define BENCH_IDLE_MOVING 10 /* percent of the chains that get a new target per frame */
+
+static float batch_history[CIK_FABRIK_BATCH_HISTORY_FLOATS * BENCH_BATCH_CHAINS];
+
+/* Target of a random pose within the limits */
+static v3 cik_bench_idle_target(void)
+{
+  float bend[BENCH_BATCH_JOINTS];
+  int i;
+
+  for (i = 0; i < BENCH_BATCH_JOINTS - 1; ++i)
+  {
+    bend[i] = 2.0f * cik_bench_random() - 1.0f;
+  }
+
+  return cik_bench_pose_target(BENCH_BATCH_JOINTS, bend);
+}
+
+/* Frames of a crowd of spherical chains where only some targets move (to poses within the
+ * limits), every frame continues from the last poses. Solved without and with dirty tracking.
+ */
+static void cik_bench_idle(void)
+{
+  int i, c, tracked, frame;
+
+  for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+  {
+    rest[i] = cik_v3((float)i, (i % 2) ? 0.3f : 0.0f, 0.0f);
+  }
+
+  for (i = 0; i < BENCH_BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = 0.8f;
+    hinge_types[i] = 0;
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -1.5f;
+    hinge_max[i] = 1.5f;
+  }
+
+  for (tracked = 0; tracked <= 1; ++tracked)
+  {
+    char name[128];
+    perf_stats_entry *entry;
+    int converged = 0;
+
+    sprintf(name, "idle n=%d chains=%d moving=%d%% %s", BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS, BENCH_IDLE_MOVING, tracked ? "tracked" : "full   ");
+
+    cik_bench_seed = 5151UL;
+
+    for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+    {
+      v3 target = cik_bench_idle_target();
+
+      for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+      {
+        batch_single[0][i * BENCH_BATCH_CHAINS + c] = rest[i].x;
+        batch_single[1][i * BENCH_BATCH_CHAINS + c] = rest[i].y;
+        batch_single[2][i * BENCH_BATCH_CHAINS + c] = rest[i].z;
+      }
+
+      batch_targets[0][c] = target.x;
+      batch_targets[1][c] = target.y;
+      batch_targets[2][c] = target.z;
+    }
+
+    cik_fabrik_batch_history_reset(batch_history, BENCH_BATCH_CHAINS);
+
+    /* Frame 0 settles the crowd and is not timed */
+    for (frame = 0; frame <= BENCH_BLOCKS; ++frame)
+    {
+      if (frame > 0)
+      {
+        for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+        {
+          if (cik_bench_random() * 100.0f < (float)BENCH_IDLE_MOVING)
+          {
+            v3 target = cik_bench_idle_target();
+
+            batch_targets[0][c] = target.x;
+            batch_targets[1][c] = target.y;
+            batch_targets[2][c] = target.z;
+          }
+        }
+      }
+
+      PERF_PROFILE_WITH_NAME({ cik_fabrik_solve_batch_lod(
+                                   batch_single[0], batch_single[1], batch_single[2], BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS,
+                                   batch_targets[0], batch_targets[1], batch_targets[2],
+                                   max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+                                   BENCH_TOLERANCE, BENCH_MAX_ITER, 0, tracked ? batch_history : 0, batch_results, batch_scratch); }, frame ? name : "idle settle");
+
+      for (c = 0; frame > 0 && c < BENCH_BATCH_CHAINS; ++c)
+      {
+        converged += batch_results[c] == 0;
+      }
+    }
+
+    entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+    printf("[cik][bench] %s | %10.1f ns/chain | %5.1f%% converged\n",
+           name,
+           entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BATCH_CHAINS),
+           100.0 * (double)converged / (double)(BENCH_BLOCKS * BENCH_BATCH_CHAINS));
+  }
+}
+
+/* A batch of mixed chains toward poses within the limits, so some chains converge in a few
+ * iterations and others run to max_iter. Solved in fixed blocks and as a refilled stream,
+ * reports the effective lane occupancy (lane iterations on active lanes over all lane
+ * iterations).
+ */
+static void cik_bench_stream(void)
+{
+  int i, c, k, stream, block_index;
+
+  cik_bench_seed = 6161UL;
+
+  for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+  {
+    rest[i] = cik_v3(0.9f * (float)i, (i & 1) ? 0.3f : 0.0f, 0.0f);
+  }
+
+  for (i = 0; i < BENCH_BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = 0.8f;
+    hinge_types[i] = i & 1;
+    hinge_axes[i] = (i & 2) ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -1.5f;
+    hinge_max[i] = 1.5f;
+  }
+
+  for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+  {
+    v3 target = cik_bench_idle_target();
+
+    for (i = 0; i < BENCH_BATCH_JOINTS; ++i)
+    {
+      batch_start[0][i * BENCH_BATCH_CHAINS + c] = rest[i].x;
+      batch_start[1][i * BENCH_BATCH_CHAINS + c] = rest[i].y;
+      batch_start[2][i * BENCH_BATCH_CHAINS + c] = rest[i].z;
+    }
+
+    batch_targets[0][c] = target.x;
+    batch_targets[1][c] = target.y;
+    batch_targets[2][c] = target.z;
+  }
+
+  for (stream = 0; stream <= 1; ++stream)
+  {
+    char name[128];
+    perf_stats_entry *entry;
+    cik_fabrik_batch batch;
+    cik_batch_block block;
+    int converged = 0;
+    int mismatches = 0;
+
+    sprintf(name, "stream n=%d chains=%d %s", BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS, stream ? "refill" : "blocks");
+
+    cik_batch_block_init(&block, BENCH_BATCH_JOINTS, batch_scratch);
+
+    for (block_index = 0; block_index < BENCH_BLOCKS; ++block_index)
+    {
+      for (k = 0; k < 3; ++k)
+      {
+        for (i = 0; i < BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS; ++i)
+        {
+          batch_threaded[k][i] = batch_start[k][i];
+        }
+      }
+
+      cik_fabrik_batch_init(
+          &batch, batch_threaded[0], batch_threaded[1], batch_threaded[2], BENCH_BATCH_JOINTS, BENCH_BATCH_CHAINS,
+          batch_targets[0], batch_targets[1], batch_targets[2],
+          max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+          BENCH_TOLERANCE, BENCH_MAX_ITER, batch_results, batch_scratch);
+
+      PERF_PROFILE_WITH_NAME({
+        if (stream)
+        {
+          cik_fabrik_batch_solve_stream(&batch, &block, 0, BENCH_BATCH_CHAINS);
+        }
+        else
+        {
+          for (c = 0; c < BENCH_BATCH_CHAINS; c += CIK_BATCH_LANES)
+          {
+            cik_fabrik_batch_solve_block(&batch, &block, c);
+          }
+        } }, name);
+    }
+
+    for (c = 0; c < BENCH_BATCH_CHAINS; ++c)
+    {
+      converged += batch_results[c] == 0;
+    }
+
+    /* Both orders must solve every chain identically */
+    for (k = 0; k < 3; ++k)
+    {
+      for (i = 0; i < BENCH_BATCH_JOINTS * BENCH_BATCH_CHAINS; ++i)
+      {
+        if (stream)
+        {
+          mismatches += batch_threaded[k][i] != batch_single[k][i];
+        }
+        else
+        {
+          batch_single[k][i] = batch_threaded[k][i];
+        }
+      }
+    }
+
+    entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+    printf("[cik][bench] %s | %10.1f ns/chain | %5.1f%% lane occupancy | %5.1f%% converged | %d mismatches\n",
+           name,
+           entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BATCH_CHAINS),
+           100.0 * (double)block.lane_iterations_run / (double)(block.iterations_run * CIK_BATCH_LANES),
+           100.0 * (double)converged / (double)BENCH_BATCH_CHAINS,
+           mismatches);
+  }
+}
+
+#define BENCH_TREE_JOINTS 10
+#define BENCH_TREE_EFFECTORS 3
+#define BENCH_TREE_ROUNDS 32 /* chain by chain passes over all effectors */
+
+static int tree_parent[BENCH_TREE_JOINTS] = {-1, 0, 1, 2, 3, 4, 2, 6, 7, 2};
+static int tree_effectors[BENCH_TREE_EFFECTORS] = {5, 8, 9};
+static v3 tree_rest[BENCH_TREE_JOINTS];
+static v3 tree_targets[BENCH_BLOCKS * BENCH_BLOCK_SOLVES][BENCH_TREE_EFFECTORS];
+static float tree_scratch[CIK_FABRIK_TREE_SCRATCH_FLOATS(BENCH_TREE_JOINTS)];
+
+/* The workaround without a tree solver: solve the root to effector path of every effector as
+ * a chain, carry the other branches along with the joints that moved and repeat until every
+ * effector is within tolerance. Returns the iterations spent.
+ */
+static int cik_bench_tree_chain_by_chain(v3 *pos, v3 *targets, int *converged)
+{
+  int iterations = 0;
+  int round, e, i, j;
+
+  *converged = 0;
+
+  for (round = 0; round < BENCH_TREE_ROUNDS && !*converged; ++round)
+  {
+    for (e = 0; e < BENCH_TREE_EFFECTORS; ++e)
+    {
+      int path[BENCH_TREE_JOINTS];
+      int on_path[BENCH_TREE_JOINTS];
+      v3 chain[BENCH_TREE_JOINTS];
+      v3 chain_rest[BENCH_TREE_JOINTS];
+      v3 delta[BENCH_TREE_JOINTS];
+      float chain_scratch[CIK_FABRIK_SCRATCH_FLOATS(BENCH_TREE_JOINTS)];
+      cik_chain path_chain;
+      float chain_max_angles[BENCH_TREE_JOINTS];
+      int chain_hinge_types[BENCH_TREE_JOINTS];
+      cik_solve_info info;
+      int count = 0;
+
+      info.trajectory = 0;
+
+      for (j = tree_effectors[e]; j >= 0; j = tree_parent[j])
+      {
+        ++count;
+      }
+
+      for (j = 0; j < BENCH_TREE_JOINTS; ++j)
+      {
+        on_path[j] = 0;
+        delta[j] = cik_v3(0.0f, 0.0f, 0.0f);
+      }
+
+      for (i = count - 1, j = tree_effectors[e]; j >= 0; --i, j = tree_parent[j])
+      {
+        path[i] = j;
+        on_path[j] = 1;
+      }
+
+      for (i = 0; i < count; ++i)
+      {
+        chain[i] = pos[path[i]];
+        chain_rest[i] = tree_rest[path[i]];
+        chain_hinge_types[i] = 0;
+      }
+
+      /* Constraint arrays are per bone, bone i of the path ends in joint path[i + 1] */
+      for (i = 0; i < count - 1; ++i)
+      {
+        chain_max_angles[i] = max_angles[path[i + 1] - 1];
+      }
+
+      /* The cones stay relative to the rest pose like in the tree solver */
+      cik_chain_init(&path_chain, chain_scratch, chain_rest, count, chain_max_angles, chain_hinge_types, hinge_axes, hinge_min, hinge_max);
+      cik_chain_solve_ex(&path_chain, chain, targets[e], BENCH_TOLERANCE, BENCH_MAX_ITER, &info);
+      iterations += info.iterations;
+
+      for (i = 0; i < count; ++i)
+      {
+        delta[path[i]] = cik_v3_sub(chain[i], pos[path[i]]);
+        pos[path[i]] = chain[i];
+      }
+
+      /* Carry the branches that are not on the path */
+      for (j = 1; j < BENCH_TREE_JOINTS; ++j)
+      {
+        if (!on_path[j])
+        {
+          delta[j] = delta[tree_parent[j]];
+          pos[j] = cik_v3_add(pos[j], delta[j]);
+        }
+      }
+    }
+
+    *converged = cik_fabrik_tree_error_2(pos, tree_effectors, targets, BENCH_TREE_EFFECTORS) <= BENCH_TOLERANCE * BENCH_TOLERANCE;
+  }
+
+  return iterations;
+}
+
+/* Targets come from random valid poses so both methods can reach them */
+static void cik_bench_tree(void)
+{
+  char *names[2] = {"tree  torso+arms+head one call    ", "tree  torso+arms+head chain/chain "};
+  int method, s, i, j, block;
+
+  cik_bench_seed = 777UL;
+
+  tree_rest[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  tree_rest[1] = cik_v3(0.0f, 1.0f, 0.0f);
+  tree_rest[2] = cik_v3(0.0f, 2.0f, 0.0f);
+  tree_rest[3] = cik_v3(-1.0f, 2.0f, 0.0f);
+  tree_rest[4] = cik_v3(-2.0f, 2.0f, 0.0f);
+  tree_rest[5] = cik_v3(-3.0f, 2.0f, 0.0f);
+  tree_rest[6] = cik_v3(1.0f, 2.0f, 0.0f);
+  tree_rest[7] = cik_v3(2.0f, 2.0f, 0.0f);
+  tree_rest[8] = cik_v3(3.0f, 2.0f, 0.0f);
+  tree_rest[9] = cik_v3(0.0f, 3.0f, 0.0f);
+
+  for (i = 0; i < BENCH_TREE_JOINTS - 1; ++i)
+  {
+    max_angles[i] = 1.0f;
+    hinge_types[i] = 0;
+  }
+
+  for (s = 0; s < BENCH_BLOCKS * BENCH_BLOCK_SOLVES; ++s)
+  {
+    v3 pose[BENCH_TREE_JOINTS];
+
+    pose[0] = tree_rest[0];
+
+    for (j = 1; j < BENCH_TREE_JOINTS; ++j)
+    {
+      v3 bone = cik_v3_sub(tree_rest[j], tree_rest[tree_parent[j]]);
+      v3 dir = cik_v3_normalize(bone);
+      v3 axis = cik_v3_normalize(cik_v3_cross(dir, cik_bench_random_dir(0)));
+
+      dir = cik_bench_rotate(dir, axis, 0.8f * cik_bench_random());
+      pose[j] = cik_v3_add(pose[tree_parent[j]], cik_v3_scale(dir, cik_v3_length(bone)));
+    }
+
+    for (i = 0; i < BENCH_TREE_EFFECTORS; ++i)
+    {
+      tree_targets[s][i] = pose[tree_effectors[i]];
+    }
+  }
+
+  for (method = 0; method < 2; ++method)
+  {
+    int iterations = 0;
+    int converged = 0;
+    perf_stats_entry *entry;
+
+    for (block = 0; block < BENCH_BLOCKS; ++block)
+    {
+      PERF_PROFILE_WITH_NAME({
+        for (s = block * BENCH_BLOCK_SOLVES; s < (block + 1) * BENCH_BLOCK_SOLVES; ++s)
+        {
+          v3 pos[BENCH_TREE_JOINTS];
+          cik_solve_info info;
+          int reached;
+
+          info.trajectory = 0;
+
+          for (j = 0; j < BENCH_TREE_JOINTS; ++j)
+          {
+            pos[j] = tree_rest[j];
+          }
+
+          if (method == 0)
+          {
+            reached = cik_fabrik_solve_tree(
+                          pos, tree_parent, BENCH_TREE_JOINTS, tree_effectors, tree_targets[s], BENCH_TREE_EFFECTORS,
+                          max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+                          BENCH_TOLERANCE, BENCH_TREE_ROUNDS * BENCH_MAX_ITER, tree_scratch, &info) == 0;
+            iterations += info.iterations;
+          }
+          else
+          {
+            iterations += cik_bench_tree_chain_by_chain(pos, tree_targets[s], &reached);
+          }
+
+          converged += reached;
+        } }, names[method]);
+    }
+
+    entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+    printf("[cik][bench] %s | %10.1f ns/solve | %6.2f iterations/solve | %6.1f%% converged\n",
+           names[method],
+           entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+           (double)iterations / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+           100.0 * (double)converged / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES));
+  }
+}
+
+#define BENCH_EXCAVATOR_JOINTS 5
+
+/* Excavator arm of the examples (boom, stick and bucket hinges around z with the same limits)
+ * mounted on a turret that swings around y, so it is not solved as a planar chain. Targets
+ * come from poses within the limits, moving targets follow a smooth path through them.
+ */
+static void cik_bench_excavator(void)
+{
+  static char *option_names[4] = {"fabrik", "fabrik+m", "fabrik+f", "fabrik+mf"};
+  static int option_flags[4] = {0, CIK_FABRIK_MOMENTUM, CIK_FABRIK_CONSTRAIN_FORWARD, CIK_FABRIK_MOMENTUM | CIK_FABRIK_CONSTRAIN_FORWARD};
+  char name[128];
+  cik_chain chain;
+  cik_solve_info info;
+  perf_stats_entry *entry;
+  int option, moving, i, s, block;
+
+  rest[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  rest[1] = cik_v3(0.5f, 0.0f, 0.0f);
+  rest[2] = cik_v3(1.5f, 1.0f, 0.0f);
+  rest[3] = cik_v3(3.5f, 0.5f, 0.0f);
+  rest[4] = cik_v3(4.5f, 0.0f, 0.0f);
+
+  for (i = 0; i < BENCH_EXCAVATOR_JOINTS - 1; ++i)
+  {
+    hinge_types[i] = 1;
+    hinge_axes[i] = i == 0 ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+    max_angles[i] = 0.0f;
+  }
+
+  hinge_min[0] = -1.5f;
+  hinge_max[0] = 1.5f;
+  hinge_min[1] = -CIK_PI_QUARTER;
+  hinge_max[1] = CIK_PI_QUARTER;
+  hinge_min[2] = 0.0f;
+  hinge_max[2] = CIK_PI * 0.75f;
+  hinge_min[3] = -CIK_PI_HALF;
+  hinge_max[3] = CIK_PI_HALF;
+
+  for (moving = 0; moving <= 1; ++moving)
+  {
+    cik_bench_seed = 9000UL + (unsigned long)moving;
+
+    for (s = 0; s < BENCH_BLOCKS * BENCH_BLOCK_SOLVES; ++s)
+    {
+      v3 end = rest[0];
+
+      for (i = 0; i < BENCH_EXCAVATOR_JOINTS - 1; ++i)
+      {
+        v3 bone = cik_v3_sub(rest[i + 1], rest[i]);
+        float t = moving ? 0.5f + 0.45f * cik_sinf(0.02f * (float)s + 1.3f * (float)i) : 0.05f + 0.9f * cik_bench_random();
+        v3 dir = cik_bench_rotate(cik_v3_normalize(bone), hinge_axes[i], hinge_min[i] + t * (hinge_max[i] - hinge_min[i]));
+
+        end = cik_v3_add(end, cik_v3_scale(dir, cik_v3_length(bone)));
+      }
+
+      targets[s] = end;
+    }
+
+    for (option = 0; option < 4; ++option)
+    {
+      long iterations = 0;
+      int converged = 0;
+
+      if (cik_chain_init(&chain, scratch, rest, BENCH_EXCAVATOR_JOINTS, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) != 0)
+      {
+        printf("[cik][bench] invalid excavator\n");
+        return;
+      }
+
+      chain.flags = option_flags[option];
+      info.trajectory = 0;
+
+      for (i = 0; i < BENCH_EXCAVATOR_JOINTS; ++i)
+      {
+        positions[i] = rest[i];
+      }
+
+      sprintf(name, "%-9s excavator %s", option_names[option], moving ? "moving" : "static");
+
+      for (block = 0; block < BENCH_BLOCKS; ++block)
+      {
+        PERF_PROFILE_WITH_NAME({
+          for (s = block * BENCH_BLOCK_SOLVES; s < (block + 1) * BENCH_BLOCK_SOLVES; ++s)
+          {
+            if (!moving)
+            {
+              for (i = 0; i < BENCH_EXCAVATOR_JOINTS; ++i)
+              {
+                positions[i] = rest[i];
+              }
+            }
+
+            cik_chain_solve_ex(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER, &info);
+            converged += info.error <= BENCH_TOLERANCE;
+            iterations += info.iterations;
+          } }, name);
+      }
+
+      entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+      printf("[cik][bench] %s | %10.1f ns/solve | %6.2f iterations/solve | %6.1f%% converged\n",
+             name,
+             entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+             (double)iterations / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+             100.0 * (double)converged / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES));
+    }
+  }
+}
+
+/* Spherical shoulder and hinge elbow, the same with a spherical wrist, and alternating hinges */
+CIK_DEFINE_FABRIK_SOLVER(cik_bench_solve_3, 3, 0x2)
+CIK_DEFINE_FABRIK_SOLVER(cik_bench_solve_4, 4, 0x2)
+CIK_DEFINE_FABRIK_SOLVER(cik_bench_solve_6, 6, 0x15)
+
+/* Generic cik_chain_solve against the unrolled solver of the same shape on the same targets.
+ * The generic solver takes the two bone closed form for 3 joints, the unrolled one iterates.
+ */
+static void cik_bench_specialized(void)
+{
+  int shapes[3] = {3, 4, 6};
+  int masks[3] = {0x2, 0x2, 0x15};
+  char name[128];
+  cik_chain chain;
+  perf_stats_entry *entry;
+  int shape, method, i, s, block;
+
+  for (shape = 0; shape < 3; ++shape)
+  {
+    int n = shapes[shape];
+
+    cik_bench_seed = 5150UL + (unsigned long)n;
+
+    for (i = 0; i < n; ++i)
+    {
+      rest[i] = cik_v3(0.9f * (float)i, (i & 1) ? 0.3f : 0.0f, 0.0f);
+    }
+
+    for (i = 0; i < n - 1; ++i)
+    {
+      max_angles[i] = 0.8f;
+      hinge_types[i] = (masks[shape] >> i) & 1;
+      hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+      hinge_min[i] = -1.5f;
+      hinge_max[i] = 1.5f;
+    }
+
+    for (s = 0; s < BENCH_BLOCKS * BENCH_BLOCK_SOLVES; ++s)
+    {
+      float bend[CIK_MAX_JOINTS];
+
+      for (i = 0; i < n - 1; ++i)
+      {
+        bend[i] = 2.0f * cik_bench_random() - 1.0f;
+      }
+
+      targets[s] = cik_bench_pose_target(n, bend);
+    }
+
+    if (cik_chain_init(&chain, scratch, rest, n, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) != 0)
+    {
+      printf("[cik][bench] invalid shape\n");
+      return;
+    }
+
+    /* Constrained forward passes let the 6 joint shape converge at all */
+    chain.flags = CIK_FABRIK_CONSTRAIN_FORWARD;
+
+    for (method = 0; method < 2; ++method)
+    {
+      int converged = 0;
+
+      sprintf(name, "%-8s n=%3d mask 0x%02x", method ? "unrolled" : "generic", n, masks[shape]);
+
+      for (block = 0; block < BENCH_BLOCKS; ++block)
+      {
+        PERF_PROFILE_WITH_NAME({
+          for (s = block * BENCH_BLOCK_SOLVES; s < (block + 1) * BENCH_BLOCK_SOLVES; ++s)
+          {
+            int code;
+
+            for (i = 0; i < n; ++i)
+            {
+              positions[i] = rest[i];
+            }
+
+            if (!method)
+            {
+              code = cik_chain_solve(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER);
+            }
+            else if (n == 3)
+            {
+              code = cik_bench_solve_3(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER);
+            }
+            else if (n == 4)
+            {
+              code = cik_bench_solve_4(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER);
+            }
+            else
+            {
+              code = cik_bench_solve_6(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER);
+            }
+
+            converged += code == 0;
+          } }, name);
+      }
+
+      entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+      printf("[cik][bench] %s | %10.1f ns/solve | %6.1f%% converged\n",
+             name,
+             entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+             100.0 * (double)converged / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES));
+    }
+  }
+}
+
+static float multistart_scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(CIK_MAX_JOINTS)];
+
+/* Single solves, a retry loop (solve again from the pose turned 180 degrees around the line
+ * from the root to the target if the first solve fails) and multi-start solves on mixed
+ * chains with targets from valid poses
+ */
+static void cik_bench_multistart(void)
+{
+  int joint_counts[3] = {4, 6, 8};
+  char *method_names[5] = {"single", "retry", "multi x2", "multi x4", "multi x8"};
+  char name[128];
+  perf_stats_entry *entry;
+  int j, method, i, s, block;
+
+  for (j = 0; j < 3; ++j)
+  {
+    int n = joint_counts[j];
+
+    cik_bench_seed = 31337UL + (unsigned long)n;
+
+    for (i = 0; i < n; ++i)
+    {
+      rest[i] = cik_v3(0.9f * (float)i, (i & 1) ? 0.3f : 0.0f, 0.0f);
+    }
+
+    for (i = 0; i < n - 1; ++i)
+    {
+      max_angles[i] = 0.8f;
+      hinge_types[i] = i & 1;
+      hinge_axes[i] = (i & 2) ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+      hinge_min[i] = -1.5f;
+      hinge_max[i] = 1.5f;
+    }
+
+    for (s = 0; s < BENCH_BLOCKS * BENCH_BLOCK_SOLVES; ++s)
+    {
+      float bend[CIK_MAX_JOINTS];
+
+      for (i = 0; i < n - 1; ++i)
+      {
+        bend[i] = 2.0f * cik_bench_random() - 1.0f;
+      }
+
+      targets[s] = cik_bench_pose_target(n, bend);
+    }
+
+    for (method = 0; method < 5; ++method)
+    {
+      int converged = 0;
+
+      sprintf(name, "%-8s n=%3d mixed", method_names[method], n);
+
+      for (block = 0; block < BENCH_BLOCKS; ++block)
+      {
+        PERF_PROFILE_WITH_NAME({
+          for (s = block * BENCH_BLOCK_SOLVES; s < (block + 1) * BENCH_BLOCK_SOLVES; ++s)
+          {
+            int code;
+
+            for (i = 0; i < n; ++i)
+            {
+              positions[i] = rest[i];
+            }
+
+            if (method >= 2)
+            {
+              code = cik_fabrik_solve_multistart(positions, n, targets[s], max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, BENCH_TOLERANCE, BENCH_MAX_ITER, 1 << (method - 1), multistart_scratch);
+            }
+            else
+            {
+              code = cik_fabrik_solve(positions, n, targets[s], max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, BENCH_TOLERANCE, BENCH_MAX_ITER);
+
+              if (method == 1 && code == 1)
+              {
+                /* The flipped pose keeps the constraints measured against the rest pose */
+                cik_chain chain;
+                v3 axis = cik_v3_normalize(cik_v3_sub(targets[s], rest[0]));
+
+                for (i = 0; i < n; ++i)
+                {
+                  v3 v = cik_v3_sub(rest[i], rest[0]);
+
+                  positions[i] = cik_v3_add(rest[0], cik_v3_sub(cik_v3_scale(axis, 2.0f * cik_v3_dot(axis, v)), v));
+                }
+
+                cik_chain_init(&chain, scratch, rest, n, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max);
+                code = cik_chain_solve(&chain, positions, targets[s], BENCH_TOLERANCE, BENCH_MAX_ITER);
+              }
+            }
+
+            converged += code == 0;
+          } }, name);
+      }
+
+      entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+      printf("[cik][bench] %s | %10.1f ns/solve | %6.1f%% converged\n",
+             name,
+             entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES),
+             100.0 * (double)converged / (double)(BENCH_BLOCKS * BENCH_BLOCK_SOLVES));
+    }
+  }
+}
+
+#define BENCH_MATH_SAMPLES 4096
+#define BENCH_MATH_TIERS 3
+
+static float math_input[BENCH_MATH_SAMPLES];
+static float math_cos[BENCH_MATH_SAMPLES];
+static float math_sin[BENCH_MATH_SAMPLES];
+static volatile float math_sink;
+
+/* Double precision references without libm: sin by its Taylor series on [-pi, pi] and
+ * 1/sqrt by Newton steps from the float estimate
+ */
+static double cik_bench_sin_reference(double x)
+{
+  double pi = 3.14159265358979323846;
+  double term, sum;
+  int k;
+
+  x -= 2.0 * pi * (double)(long)(x / (2.0 * pi));
+  x = x > pi ? x - 2.0 * pi : (x < -pi ? x + 2.0 * pi : x);
+  term = x;
+  sum = x;
+
+  for (k = 1; k < 20; ++k)
+  {
+    term *= -x * x / (double)((2 * k) * (2 * k + 1));
+    sum += term;
+  }
+
+  return sum;
+}
+
+static double cik_bench_invsqrt_reference(float x)
+{
+  double y = (double)cik_invsqrt_steps(x, 3);
+  int k;
+
+  for (k = 0; k < 4; ++k)
+  {
+    y = y * (1.5 - 0.5 * (double)x * y * y);
+  }
+
+  return y;
+}
+
+static double cik_bench_abs(double x)
+{
+  return x < 0.0 ? -x : x;
+}
+
+static float cik_bench_tier_sin(int tier, float x)
+{
+  return tier == 0 ? cik_sinf_lut(x) : (tier == 1 ? cik_sinf_minimax7(x) : cik_sinf_minimax9(x));
+}
+
+static float cik_bench_tier_atan2(int tier, float y, float x)
+{
+  return tier == 0 ? cik_atan2f_rational(y, x) : (tier == 1 ? cik_atan2f_minimax11(y, x) : cik_atan2f_minimax15(y, x));
+}
+
+/* Newton steps cik_invsqrt takes in each tier */
+static int cik_bench_tier_steps(int tier)
+{
+#ifdef CIK_USE_SSE
+  return tier == 2 ? 2 : 1;
+#else
+  return tier + 1;
+#endif
+}
+
+/* Accuracy and throughput of the math kernels per tier. The error is the maximum absolute
+ * error (relative for 1/sqrt) over angles in [-pi, pi] and lengths in [1e-4, 1e4], the time
+ * is per call.
+ */
+static void cik_bench_math(void)
+{
+  static char *tier_names[BENCH_MATH_TIERS] = {"fast", "balanced", "precise"};
+  double pi = 3.14159265358979323846;
+  int tier, i, block;
+
+  for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+  {
+    double a = -pi + 2.0 * pi * ((double)i + 0.5) / (double)BENCH_MATH_SAMPLES;
+
+    math_input[i] = (float)a;
+    math_sin[i] = (float)cik_bench_sin_reference(a);
+    math_cos[i] = (float)cik_bench_sin_reference(a + 0.5 * pi);
+  }
+
+  printf("[cik][bench] math tier |  sin error |   sin ns | atan2 error | atan2 ns | 1/sqrt rel error | 1/sqrt ns\n");
+
+  for (tier = 0; tier < BENCH_MATH_TIERS; ++tier)
+  {
+    double sin_error = 0.0, atan2_error = 0.0, invsqrt_error = 0.0;
+    double ns[3];
+    double length = 1e-4;
+    int steps = cik_bench_tier_steps(tier);
+    int k;
+
+    for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+    {
+      double a = (double)math_input[i];
+      double e = cik_bench_abs((double)cik_bench_tier_sin(tier, math_input[i]) - (double)math_sin[i]);
+
+      sin_error = e > sin_error ? e : sin_error;
+
+      /* The exact angle of (cos a, sin a) is a itself */
+      e = cik_bench_abs((double)cik_bench_tier_atan2(tier, math_sin[i], math_cos[i]) - a);
+      atan2_error = e > atan2_error ? e : atan2_error;
+
+      /* Lengths are spaced logarithmically, 10^(8 / BENCH_MATH_SAMPLES) apart */
+      e = cik_bench_abs((double)cik_invsqrt_steps((float)length, steps) / cik_bench_invsqrt_reference((float)length) - 1.0);
+      invsqrt_error = e > invsqrt_error ? e : invsqrt_error;
+      length *= 1.0045073642544624;
+    }
+
+    for (k = 0; k < 3; ++k)
+    {
+      char name[64];
+      perf_stats_entry *entry;
+      static char *function_names[3] = {"sin", "atan2", "1/sqrt"};
+
+      sprintf(name, "math %s %s", function_names[k], tier_names[tier]);
+
+      for (block = 0; block < BENCH_BLOCKS; ++block)
+      {
+        float sum = 0.0f;
+
+        PERF_PROFILE_WITH_NAME({
+          for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+          {
+            sum += k == 0 ? cik_bench_tier_sin(tier, math_input[i]) : (k == 1 ? cik_bench_tier_atan2(tier, math_sin[i], math_cos[i]) : cik_invsqrt_steps(1.0f + math_cos[i] * math_cos[i], steps));
+          } }, name);
+
+        math_sink = sum;
+      }
+
+      entry = &perf_stats_entries[perf_stats_entry_count - 1];
+      ns[k] = entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_MATH_SAMPLES);
+    }
+
+    printf("[cik][bench] %-9s | %10.2e | %8.2f | %11.2e | %8.2f | %16.2e | %9.2f\n",
+           tier_names[tier], sin_error, ns[0], atan2_error, ns[1], invsqrt_error, ns[2]);
+  }
+}
+
+#define BENCH_RSQRT_VARIANTS 7
+
+static float rsqrt_input[BENCH_MATH_SAMPLES];
+static float rsqrt_output[BENCH_MATH_SAMPLES];
+
+/* Fills rsqrt_output with 1 / sqrt(rsqrt_input) using one of the variants */
+static void cik_bench_rsqrt_variant(int variant)
+{
+  int i;
+
+  switch (variant)
+  {
+  case 0:
+#ifdef BENCH_X86
+    for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+    {
+      rsqrt_output[i] = 1.0f / _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(rsqrt_input[i])));
+    }
+#endif
+    break;
+  case 1:
+#ifdef BENCH_X86
+    for (i = 0; i < BENCH_MATH_SAMPLES; i += 4)
+    {
+      __m128 n = _mm_loadu_ps(rsqrt_input + i);
+      __m128 y = _mm_rsqrt_ps(n);
+
+      y = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), y), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(n, _mm_mul_ps(y, y))));
+      _mm_storeu_ps(rsqrt_output + i, y);
+    }
+#endif
+    break;
+  case 2:
+    for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+    {
+      rsqrt_output[i] = cik_invsqrt(rsqrt_input[i]);
+    }
+    break;
+  case 3:
+    cik_invsqrt_lanes(rsqrt_input, rsqrt_output, BENCH_MATH_SAMPLES);
+    break;
+  default:
+    for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+    {
+      rsqrt_output[i] = cik_invsqrt_soft(rsqrt_input[i], variant - 3);
+    }
+    break;
+  }
+}
+
+/* Throughput and maximum relative error of 1 / sqrt over an array of lengths in [1e-4, 1e4] */
+static void cik_bench_rsqrt(void)
+{
+  static char *variant_names[BENCH_RSQRT_VARIANTS] = {
+      "1/sqrtf", "_mm_rsqrt_ps + newton", "cik_invsqrt", "cik_invsqrt_lanes",
+      "cik_invsqrt_soft 1 step", "cik_invsqrt_soft 2 steps", "cik_invsqrt_soft 3 steps"};
+  double length = 1e-4;
+  int variant, i, block;
+
+  for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+  {
+    rsqrt_input[i] = (float)length;
+    length *= 1.0045073642544624;
+  }
+
+  printf("[cik][bench] rsqrt variant            | rel error | ns/value\n");
+
+  for (variant = 0; variant < BENCH_RSQRT_VARIANTS; ++variant)
+  {
+    char name[64];
+    perf_stats_entry *entry;
+    double error = 0.0;
+
+#ifndef BENCH_X86
+    if (variant < 2)
+    {
+      continue;
+    }
+#endif
+
+    sprintf(name, "rsqrt %s", variant_names[variant]);
+
+    for (block = 0; block < BENCH_BLOCKS; ++block)
+    {
+      PERF_PROFILE_WITH_NAME({ cik_bench_rsqrt_variant(variant); }, name);
+      math_sink = rsqrt_output[block];
+    }
+
+    for (i = 0; i < BENCH_MATH_SAMPLES; ++i)
+    {
+      double e = cik_bench_abs((double)rsqrt_output[i] / cik_bench_invsqrt_reference(rsqrt_input[i]) - 1.0);
+      error = e > error ? e : error;
+    }
+
+    entry = &perf_stats_entries[perf_stats_entry_count - 1];
+
+    printf("[cik][bench] %-24s | %9.2e | %8.3f\n", variant_names[variant], error,
+           entry->time_ms_sum * 1000000.0 / (double)(BENCH_BLOCKS * BENCH_MATH_SAMPLES));
+  }
+}
+
+int main(void)
+{
+  int joint_counts[] = {2, 3, 4, 8, 16, 32, 64, 128};
+  int j, c, t, moving, solver;
+
+  for (j = 0; j < (int)(sizeof(joint_counts) / sizeof(joint_counts[0])); ++j)
+  {
+    for (c = CIK_BENCH_SPHERICAL; c <= CIK_BENCH_MIXED; ++c)
+    {
+      for (t = CIK_BENCH_REACHABLE; t <= CIK_BENCH_NEAR_SINGULAR; ++t)
+      {
+        for (moving = 0; moving <= 1; ++moving)
+        {
+          /* All solvers run on the same seeded targets, next to each other in the output */
+          for (solver = CIK_BENCH_FABRIK; solver <= CIK_BENCH_HYBRID; ++solver)
+          {
+            cik_bench_scenario((cik_bench_solvers)solver, joint_counts[j], (cik_bench_constraints)c, (cik_bench_targets)t, moving);
+          }
+        }
+      }
+    }
+  }
+
+  cik_bench_threads();
+  cik_bench_lod();
+  cik_bench_idle();
+  cik_bench_stream();
+  cik_bench_tree();
+  cik_bench_excavator();
+  cik_bench_specialized();
+  cik_bench_multistart();
+  cik_bench_math();
+  cik_bench_rsqrt();
+
+  fflush(stdout);
+  perf_print_stats();
+
+  return 0;
+}
+
+/*
+   -----------------------------------------------------------------------------
+   This software is available under 2 licenses -- choose whichever you prefer.
+   ------------------------------------------------------------------------------
+   ALTERNATIVE A - MIT License
+   Copyright (c) 2025 nickscha
+   Permission is hereby granted, free of charge, to any person obtaining a copy of
+   this software and associated documentation files (the "Software"), to deal in
+   the Software without restriction, including without limitation the rights to
+   use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is furnished to do
+   so, subject to the following conditions:
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+   ------------------------------------------------------------------------------
+   ALTERNATIVE B - Public Domain (www.unlicense.org)
+   This is free and unencumbered software released into the public domain.
+   Anyone is free to copy, modify, publish, use, compile, sell, or distribute this
+   software, either in source code form or as a compiled binary, for any purpose,
+   commercial or non-commercial, and by any means.
+   In jurisdictions that recognize copyright laws, the author or authors of this
+   software dedicate any and all copyright interest in the software to the public
+   domain. We make this dedication for the benefit of the public at large and to
+   the detriment of our heirs and successors. We intend this dedication to be an
+   overt act of relinquishment in perpetuity of all present and future rights to
+   this software under copyright law.
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+   WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+   ------------------------------------------------------------------------------
+*/
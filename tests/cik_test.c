@@ -94,9 +94,1744 @@ void cik_test_fabrik_solver_direct(void)
   printf("[cik][fabrik] finished simulation\n");
 }
 
+void cik_test_fabrik_solve_batch(void)
+{
+#define BATCH_JOINTS 4
+#define BATCH_CHAINS 11
+
+  float x[BATCH_JOINTS * BATCH_CHAINS];
+  float y[BATCH_JOINTS * BATCH_CHAINS];
+  float z[BATCH_JOINTS * BATCH_CHAINS];
+  float target_x[BATCH_CHAINS];
+  float target_y[BATCH_CHAINS];
+  float target_z[BATCH_CHAINS];
+  int results[BATCH_CHAINS];
+
+  v3 positions[BATCH_JOINTS];
+  v3 hinge_axes[BATCH_JOINTS - 1];
+  int hinge_types[BATCH_JOINTS - 1];
+  float max_angles[BATCH_JOINTS - 1];
+  float hinge_min[BATCH_JOINTS - 1];
+  float hinge_max[BATCH_JOINTS - 1];
+
+  int i, c, n, planar;
+
+  for (i = 0; i < BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = CIK_PI * 0.5f;
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -CIK_PI_HALF;
+    hinge_max[i] = CIK_PI_HALF;
+  }
+
+  /* The first pass mixes spherical joints and a hinge, the second shares the Z axis between all hinges, which takes the planar path */
+  for (planar = 0; planar < 2; ++planar)
+  {
+    for (i = 0; i < BATCH_JOINTS - 1; ++i)
+    {
+      hinge_types[i] = planar || i == 1; /* spherical, hinge, spherical */
+    }
+
+    /* Three joints go through the closed form two-bone path, four through the lane iteration */
+    for (n = 3; n <= BATCH_JOINTS; ++n)
+    {
+      /* Every chain starts straight along X, targets are spread around (the last one is unreachable) */
+      for (c = 0; c < BATCH_CHAINS; ++c)
+      {
+        for (i = 0; i < n; ++i)
+        {
+          x[i * BATCH_CHAINS + c] = (float)i;
+          y[i * BATCH_CHAINS + c] = (i == 1) ? 0.1f : 0.0f;
+          z[i * BATCH_CHAINS + c] = 0.0f;
+        }
+
+        target_x[c] = 2.0f - 0.1f * (float)c;
+        target_y[c] = 0.2f * (float)c;
+        target_z[c] = (c == BATCH_CHAINS - 1) ? 10.0f : 0.05f * (float)c;
+      }
+
+      cik_fabrik_solve_batch(
+          x, y, z,
+          n, BATCH_CHAINS,
+          target_x, target_y, target_z,
+          max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+          1e-3f, 32,
+          results);
+
+      /* Every chain must match the scalar solver */
+      for (c = 0; c < BATCH_CHAINS; ++c)
+      {
+        int expected;
+
+        for (i = 0; i < n; ++i)
+        {
+          positions[i] = cik_v3((float)i, (i == 1) ? 0.1f : 0.0f, 0.0f);
+        }
+
+        expected = cik_fabrik_solve(
+            positions, n,
+            cik_v3(target_x[c], target_y[c], target_z[c]),
+            max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+            1e-3f, 32);
+
+        assert(results[c] == expected);
+
+        for (i = 0; i < n; ++i)
+        {
+          assert_equalsf(x[i * BATCH_CHAINS + c], positions[i].x, 1e-4f);
+          assert_equalsf(y[i * BATCH_CHAINS + c], positions[i].y, 1e-4f);
+          assert_equalsf(z[i * BATCH_CHAINS + c], positions[i].z, 1e-4f);
+        }
+      }
+
+      assert(results[BATCH_CHAINS - 1] == 3);
+    }
+  }
+
+#undef BATCH_JOINTS
+#undef BATCH_CHAINS
+}
+
+void cik_test_fabrik_solve_batch_lod(void)
+{
+#define BATCH_JOINTS 4
+#define BATCH_CHAINS 12
+
+  float x[BATCH_JOINTS * BATCH_CHAINS];
+  float y[BATCH_JOINTS * BATCH_CHAINS];
+  float z[BATCH_JOINTS * BATCH_CHAINS];
+  float target_x[BATCH_CHAINS];
+  float target_y[BATCH_CHAINS];
+  float target_z[BATCH_CHAINS];
+  float importance[BATCH_CHAINS];
+  float history[CIK_FABRIK_BATCH_HISTORY_FLOATS * BATCH_CHAINS];
+  float moved[BATCH_JOINTS * BATCH_CHAINS];
+  int results[BATCH_CHAINS];
+  int settled[BATCH_CHAINS];
+  float scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(BATCH_JOINTS) + BATCH_CHAINS];
+
+  v3 positions[BATCH_JOINTS];
+  v3 hinge_axes[BATCH_JOINTS - 1];
+  int hinge_types[BATCH_JOINTS - 1];
+  float max_angles[BATCH_JOINTS - 1];
+  float hinge_min[BATCH_JOINTS - 1];
+  float hinge_max[BATCH_JOINTS - 1];
+  float levels[4] = {1.0f, 0.6f, 0.2f, 0.0f};
+
+  int i, c;
+
+  /* Tiers, settings per tier and the camera distance mapping */
+  assert(cik_fabrik_lod_tier(0.0f) == 0);
+  assert(cik_fabrik_lod_tier(0.01f) == 1);
+  assert(cik_fabrik_lod_tier(0.25f) == 1);
+  assert(cik_fabrik_lod_tier(0.6f) == 3);
+  assert(cik_fabrik_lod_tier(2.0f) == CIK_LOD_TIERS);
+  assert(cik_fabrik_lod_policy(CIK_LOD_TIERS, 1e-3f, 32).max_iter == 32);
+  assert(cik_fabrik_lod_policy(CIK_LOD_TIERS, 1e-3f, 32).tolerance == 1e-3f);
+  assert(cik_fabrik_lod_policy(CIK_LOD_TIERS, 1e-3f, 32).constrain == 1);
+  assert(cik_fabrik_lod_policy(1, 1e-3f, 32).max_iter == 32 / CIK_LOD_TIERS);
+  assert(cik_fabrik_lod_policy(1, 1e-3f, 32).tolerance > 1e-3f);
+  assert(cik_fabrik_lod_policy(1, 1e-3f, 32).constrain == 0);
+  assert(cik_lod_importance(cik_v3(0.0f, 0.0f, 0.0f), cik_v3(0.0f, 0.0f, 5.0f), 1.0f, 10.0f, 1) == 1.0f);
+  assert_equalsf(cik_lod_importance(cik_v3(0.0f, 0.0f, 0.0f), cik_v3(0.0f, 0.0f, 41.0f), 1.0f, 10.0f, 1), 0.25f, 1e-3f);
+  assert(cik_lod_importance(cik_v3(0.0f, 0.0f, 0.0f), cik_v3(0.0f, 0.0f, 5.0f), 1.0f, 10.0f, 0) == 0.0f);
+
+  for (i = 0; i < BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = CIK_PI * 0.5f;
+    hinge_types[i] = (i == 1); /* spherical, hinge, spherical */
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -CIK_PI_HALF;
+    hinge_max[i] = CIK_PI_HALF;
+  }
+
+  /* Importance cycles through full, reduced, unconstrained and not solved */
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    for (i = 0; i < BATCH_JOINTS; ++i)
+    {
+      x[i * BATCH_CHAINS + c] = (float)i;
+      y[i * BATCH_CHAINS + c] = (i == 1) ? 0.1f : 0.0f;
+      z[i * BATCH_CHAINS + c] = 0.0f;
+    }
+
+    target_x[c] = 2.0f - 0.1f * (float)c;
+    target_y[c] = 0.2f * (float)c;
+    target_z[c] = 0.05f * (float)c;
+    importance[c] = levels[c % 4];
+  }
+
+  cik_fabrik_batch_history_reset(history, BATCH_CHAINS);
+  cik_fabrik_solve_batch_lod(
+      x, y, z,
+      BATCH_JOINTS, BATCH_CHAINS,
+      target_x, target_y, target_z,
+      max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+      1e-3f, 32, importance, history,
+      results, scratch);
+
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    cik_fabrik_lod lod = cik_fabrik_lod_policy(cik_fabrik_lod_tier(importance[c]), 1e-3f, 32);
+    v3 target = cik_v3(target_x[c], target_y[c], target_z[c]);
+
+    for (i = 0; i < BATCH_JOINTS; ++i)
+    {
+      positions[i] = cik_v3((float)i, (i == 1) ? 0.1f : 0.0f, 0.0f);
+    }
+
+    if (importance[c] == 0.0f)
+    {
+      /* Not solved, pose untouched */
+      assert(results[c] == 1);
+
+      for (i = 0; i < BATCH_JOINTS; ++i)
+      {
+        assert(x[i * BATCH_CHAINS + c] == positions[i].x && y[i * BATCH_CHAINS + c] == positions[i].y && z[i * BATCH_CHAINS + c] == positions[i].z);
+      }
+    }
+    else if (lod.constrain)
+    {
+      /* Constrained tiers match the scalar solver with the tier settings */
+      assert(results[c] == cik_fabrik_solve(positions, BATCH_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, lod.tolerance, lod.max_iter));
+
+      for (i = 0; i < BATCH_JOINTS; ++i)
+      {
+        assert_equalsf(x[i * BATCH_CHAINS + c], positions[i].x, 1e-4f);
+        assert_equalsf(y[i * BATCH_CHAINS + c], positions[i].y, 1e-4f);
+        assert_equalsf(z[i * BATCH_CHAINS + c], positions[i].z, 1e-4f);
+      }
+    }
+    else
+    {
+      /* Unconstrained tier, reaches the coarser tolerance with the bone lengths kept */
+      v3 end = cik_v3(x[(BATCH_JOINTS - 1) * BATCH_CHAINS + c], y[(BATCH_JOINTS - 1) * BATCH_CHAINS + c], z[(BATCH_JOINTS - 1) * BATCH_CHAINS + c]);
+
+      assert(results[c] == 0);
+      assert(cik_v3_length(cik_v3_sub(end, target)) <= lod.tolerance);
+
+      for (i = 0; i < BATCH_JOINTS - 1; ++i)
+      {
+        v3 bone = cik_v3(x[(i + 1) * BATCH_CHAINS + c] - x[i * BATCH_CHAINS + c], y[(i + 1) * BATCH_CHAINS + c] - y[i * BATCH_CHAINS + c], z[(i + 1) * BATCH_CHAINS + c] - z[i * BATCH_CHAINS + c]);
+
+        assert_equalsf(cik_v3_length(bone), cik_v3_length(cik_v3_sub(positions[i + 1], positions[i])), 1e-3f);
+      }
+    }
+  }
+
+  /* Same targets again: the settled chains keep their pose and result */
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    settled[c] = results[c];
+  }
+
+  for (i = 0; i < BATCH_JOINTS * BATCH_CHAINS; ++i)
+  {
+    moved[i] = x[i];
+  }
+
+  cik_fabrik_solve_batch_lod(x, y, z, BATCH_JOINTS, BATCH_CHAINS, target_x, target_y, target_z, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, importance, history, results, scratch);
+
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    /* Chains that stopped at max_iter or stalled are solved again */
+    if (settled[c] == 1 && importance[c] > 0.0f)
+    {
+      continue;
+    }
+
+    assert(results[c] == settled[c]);
+
+    for (i = 0; i < BATCH_JOINTS; ++i)
+    {
+      assert(x[i * BATCH_CHAINS + c] == moved[i * BATCH_CHAINS + c]);
+    }
+  }
+
+  /* Raising the importance solves the coarse chains again at full detail */
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    importance[c] = importance[c] > 0.0f ? 1.0f : 0.0f;
+  }
+
+  cik_fabrik_solve_batch_lod(x, y, z, BATCH_JOINTS, BATCH_CHAINS, target_x, target_y, target_z, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, importance, history, results, scratch);
+
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    if (importance[c] > 0.0f && results[c] == 0)
+    {
+      v3 end = cik_v3(x[(BATCH_JOINTS - 1) * BATCH_CHAINS + c], y[(BATCH_JOINTS - 1) * BATCH_CHAINS + c], z[(BATCH_JOINTS - 1) * BATCH_CHAINS + c]);
+
+      assert(cik_v3_length(cik_v3_sub(end, cik_v3(target_x[c], target_y[c], target_z[c]))) <= 1e-3f);
+    }
+  }
+
+#undef BATCH_JOINTS
+#undef BATCH_CHAINS
+}
+
+void cik_test_fabrik_solve_batch_stream(void)
+{
+#define BATCH_JOINTS 4
+#define BATCH_CHAINS 29
+
+  float x[2][BATCH_JOINTS * BATCH_CHAINS];
+  float y[2][BATCH_JOINTS * BATCH_CHAINS];
+  float z[2][BATCH_JOINTS * BATCH_CHAINS];
+  float target_x[BATCH_CHAINS];
+  float target_y[BATCH_CHAINS];
+  float target_z[BATCH_CHAINS];
+  int results[2][BATCH_CHAINS];
+  float occupancy[2];
+  float scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(BATCH_JOINTS)];
+
+  v3 hinge_axes[BATCH_JOINTS - 1];
+  int hinge_types[BATCH_JOINTS - 1];
+  float max_angles[BATCH_JOINTS - 1];
+  float hinge_min[BATCH_JOINTS - 1];
+  float hinge_max[BATCH_JOINTS - 1];
+
+  cik_fabrik_batch batch;
+  cik_batch_block block;
+  int i, c, k;
+
+  for (i = 0; i < BATCH_JOINTS - 1; ++i)
+  {
+    max_angles[i] = 0.8f;
+    hinge_types[i] = (i == 1);
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -1.5f;
+    hinge_max[i] = 1.5f;
+  }
+
+  /* Near, far, unreachable and constrained targets so the chains finish at different iterations */
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    for (k = 0; k < 2; ++k)
+    {
+      for (i = 0; i < BATCH_JOINTS; ++i)
+      {
+        x[k][i * BATCH_CHAINS + c] = (float)i;
+        y[k][i * BATCH_CHAINS + c] = (i == 1) ? 0.1f : 0.0f;
+        z[k][i * BATCH_CHAINS + c] = 0.0f;
+      }
+    }
+
+    target_x[c] = 3.0f - 0.15f * (float)c;
+    target_y[c] = 0.1f * (float)(c % 7);
+    target_z[c] = (c % 5 == 4) ? 10.0f : 0.02f * (float)c;
+  }
+
+  /* Fixed blocks and the refilled stream give the same chains the same poses and results */
+  for (k = 0; k < 2; ++k)
+  {
+    assert(cik_fabrik_batch_init(
+        &batch, x[k], y[k], z[k], BATCH_JOINTS, BATCH_CHAINS, target_x, target_y, target_z,
+        max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, results[k], scratch));
+    cik_batch_block_init(&block, BATCH_JOINTS, scratch);
+
+    if (k == 0)
+    {
+      for (c = 0; c < BATCH_CHAINS; c += CIK_BATCH_LANES)
+      {
+        cik_fabrik_batch_solve_block(&batch, &block, c);
+      }
+    }
+    else
+    {
+      cik_fabrik_batch_solve_stream(&batch, &block, 0, BATCH_CHAINS);
+    }
+
+    occupancy[k] = (float)block.lane_iterations_run / (float)(block.iterations_run * CIK_BATCH_LANES);
+  }
+
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    assert(results[0][c] == results[1][c]);
+  }
+
+  for (i = 0; i < BATCH_JOINTS * BATCH_CHAINS; ++i)
+  {
+    assert(x[0][i] == x[1][i] && y[0][i] == y[1][i] && z[0][i] == z[1][i]);
+  }
+
+  assert(occupancy[1] > occupancy[0]);
+
+#undef BATCH_JOINTS
+#undef BATCH_CHAINS
+}
+
+/* Built with -DCIK_THREADS (and -pthread on Linux) */
+#ifdef CIK_THREADS
+void cik_test_fabrik_solve_batch_threaded(void)
+{
+#define THREADED_JOINTS 5
+#define THREADED_CHAINS 37
+
+  static float x0[THREADED_JOINTS * THREADED_CHAINS], y0[THREADED_JOINTS * THREADED_CHAINS], z0[THREADED_JOINTS * THREADED_CHAINS];
+  static float x[THREADED_JOINTS * THREADED_CHAINS], y[THREADED_JOINTS * THREADED_CHAINS], z[THREADED_JOINTS * THREADED_CHAINS];
+  static float scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(THREADED_JOINTS) * 8];
+  float target_x[THREADED_CHAINS];
+  float target_y[THREADED_CHAINS];
+  float target_z[THREADED_CHAINS];
+  int expected[THREADED_CHAINS];
+  int results[THREADED_CHAINS];
+
+  v3 hinge_axes[THREADED_JOINTS - 1];
+  int hinge_types[THREADED_JOINTS - 1];
+  float max_angles[THREADED_JOINTS - 1];
+  float hinge_min[THREADED_JOINTS - 1];
+  float hinge_max[THREADED_JOINTS - 1];
+
+  int threads[3] = {1, 3, 8};
+  int i, c, t;
+
+  assert(cik_fabrik_batch_threaded_scratch_size(THREADED_JOINTS, 8) == sizeof(scratch));
+  assert(cik_fabrik_batch_threaded_scratch_size(THREADED_JOINTS, 0) == cik_fabrik_batch_scratch_size(THREADED_JOINTS));
+
+  for (i = 0; i < THREADED_JOINTS - 1; ++i)
+  {
+    max_angles[i] = CIK_PI * 0.5f;
+    hinge_types[i] = (i == 2);
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -CIK_PI_HALF;
+    hinge_max[i] = CIK_PI_HALF;
+  }
+
+  for (c = 0; c < THREADED_CHAINS; ++c)
+  {
+    for (i = 0; i < THREADED_JOINTS; ++i)
+    {
+      x0[i * THREADED_CHAINS + c] = (float)i;
+      y0[i * THREADED_CHAINS + c] = (i % 2) ? 0.1f : 0.0f;
+      z0[i * THREADED_CHAINS + c] = 0.0f;
+    }
+
+    target_x[c] = 3.0f - 0.1f * (float)c;
+    target_y[c] = 0.05f * (float)c;
+    target_z[c] = (c % 9 == 8) ? 10.0f : 0.02f * (float)c;
+  }
+
+  /* Single threaded reference */
+  for (i = 0; i < THREADED_JOINTS * THREADED_CHAINS; ++i)
+  {
+    x[i] = x0[i];
+    y[i] = y0[i];
+    z[i] = z0[i];
+  }
+
+  cik_fabrik_solve_batch_scratch(
+      x, y, z, THREADED_JOINTS, THREADED_CHAINS, target_x, target_y, target_z,
+      max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+      1e-3f, 32, expected, scratch);
+
+  /* The result of every chain must not depend on the thread count */
+  for (t = 0; t < 3; ++t)
+  {
+    static float rx[THREADED_JOINTS * THREADED_CHAINS], ry[THREADED_JOINTS * THREADED_CHAINS], rz[THREADED_JOINTS * THREADED_CHAINS];
+
+    for (i = 0; i < THREADED_JOINTS * THREADED_CHAINS; ++i)
+    {
+      rx[i] = x0[i];
+      ry[i] = y0[i];
+      rz[i] = z0[i];
+    }
+
+    cik_fabrik_solve_batch_threaded(
+        rx, ry, rz, THREADED_JOINTS, THREADED_CHAINS, target_x, target_y, target_z,
+        max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+        1e-3f, 32, results, threads[t], scratch);
+
+    for (c = 0; c < THREADED_CHAINS; ++c)
+    {
+      assert(results[c] == expected[c]);
+    }
+
+    for (i = 0; i < THREADED_JOINTS * THREADED_CHAINS; ++i)
+    {
+      assert(rx[i] == x[i] && ry[i] == y[i] && rz[i] == z[i]);
+    }
+  }
+
+  /* Invalid input */
+  cik_fabrik_solve_batch_threaded(
+      x, y, z, 1, THREADED_CHAINS, target_x, target_y, target_z,
+      max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+      1e-3f, 32, results, 4, scratch);
+
+  assert(results[0] == 2 && results[THREADED_CHAINS - 1] == 2);
+
+#undef THREADED_JOINTS
+#undef THREADED_CHAINS
+}
+#endif /* CIK_THREADS */
+
+void cik_test_chain_rest_pose(void)
+{
+  cik_chain chain;
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(3)];
+  v3 positions[3];
+  v3 hinge_axes[2];
+  int hinge_types[2] = {0, 0};
+  float max_angles[2] = {0.5f, CIK_PI};
+  float hinge_min[2] = {0.0f, 0.0f};
+  float hinge_max[2] = {0.0f, 0.0f};
+  v3 rest_dir = cik_v3(1.0f, 0.0f, 0.0f);
+  int i;
+
+  positions[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  positions[1] = cik_v3(1.0f, 0.0f, 0.0f);
+  positions[2] = cik_v3(2.0f, 0.0f, 0.0f);
+  hinge_axes[0] = hinge_axes[1] = cik_v3(0.0f, 0.0f, 1.0f);
+
+  assert(cik_chain_init(&chain, scratch, positions, 3, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert_equalsf(chain.total_len, 2.0f, 1e-2f);
+  assert_equalsf(chain.total_len_2, chain.total_len * chain.total_len, 1e-6f);
+
+  /* Repeated solves toward a target outside the cone must not let the root bone drift past its rest limit */
+  for (i = 0; i < 4; ++i)
+  {
+    v3 dir;
+
+    cik_chain_solve(&chain, positions, cik_v3(0.2f, 1.5f, 0.0f), 1e-3f, 16);
+
+    dir = cik_v3_normalize(cik_v3_sub(positions[1], positions[0]));
+    assert(cik_v3_dot(dir, rest_dir) >= cik_cosf(max_angles[0]) - 1e-2f);
+  }
+
+  assert(cik_chain_init(&chain, scratch, positions, 1, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 2);
+}
+
+void cik_test_solve_two_bone(void)
+{
+  v3 positions[3];
+  v3 hinge_axes[2];
+  v3 target = cik_v3(2.0f, 1.0f, 0.0f);
+  int hinge_types[2] = {0, 0};
+  float max_angles[2] = {CIK_PI, CIK_PI};
+  float hinge_min[2] = {-CIK_PI, -CIK_PI};
+  float hinge_max[2] = {CIK_PI, CIK_PI};
+
+  hinge_axes[0] = hinge_axes[1] = cik_v3(0.0f, 0.0f, 1.0f);
+
+  /* Unconstrained: end effector on the target, elbow on the pole side, bone lengths kept */
+  positions[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  positions[1] = cik_v3(1.5f, 0.1f, 0.0f);
+  positions[2] = cik_v3(3.0f, 0.0f, 0.0f);
+
+  assert(cik_solve_two_bone(positions, target, cik_v3(1.5f, -1.0f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert_equalsf(cik_v3_length(cik_v3_sub(positions[2], target)), 0.0f, 1e-5f);
+  assert_equalsf(cik_v3_length(cik_v3_sub(positions[1], positions[0])), 1.5f, 1e-2f);
+  assert_equalsf(cik_v3_length(cik_v3_sub(positions[2], positions[1])), 1.5f, 1e-2f);
+  assert(positions[1].y < 0.0f);
+
+  /* Narrow elbow hinge: the pole side violates the limit so the other side is used */
+  hinge_types[1] = 1;
+  hinge_min[1] = -0.3f;
+  hinge_max[1] = 0.3f;
+  positions[1] = cik_v3(1.5f, 0.1f, 0.0f);
+  positions[2] = cik_v3(3.0f, 0.0f, 0.0f);
+
+  assert(cik_solve_two_bone(positions, target, cik_v3(1.5f, -1.0f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert_equalsf(cik_v3_length(cik_v3_sub(positions[2], target)), 0.0f, 1e-5f);
+  assert(positions[1].y > 0.0f);
+
+  /* Target inside the minimum reach leaves the pose untouched */
+  positions[1] = cik_v3(2.0f, 0.0f, 0.0f);
+  positions[2] = cik_v3(3.0f, 0.0f, 0.0f);
+
+  assert(cik_solve_two_bone(positions, cik_v3(0.2f, 0.0f, 0.0f), positions[1], max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 1);
+  assert_equalsf(positions[2].x, 3.0f, 1e-6f);
+}
+
+void cik_test_fabrik_solve_planar(void)
+{
+  v3 rest[4];
+  v3 positions[4];
+  v3 hinge_axes[3];
+  v3 target = cik_v3(3.2f, 0.4f, 0.0f);
+  int hinge_types[3] = {1, 1, 1};
+  float hinge_min[3] = {-CIK_PI_QUARTER, 0.0f, -CIK_PI_HALF};
+  float hinge_max[3] = {CIK_PI_QUARTER, CIK_PI * 0.75f, CIK_PI_HALF};
+  float angles[3];
+  int i;
+
+  rest[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  rest[1] = cik_v3(1.0f, 1.0f, 0.0f);
+  rest[2] = cik_v3(3.0f, 0.5f, 0.0f);
+  rest[3] = cik_v3(4.0f, 0.0f, 0.0f);
+  hinge_axes[0] = hinge_axes[1] = hinge_axes[2] = cik_v3(0.0f, 0.0f, 1.0f);
+
+  for (i = 0; i < 4; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  assert(cik_fabrik_solve_planar(positions, 4, target, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, angles) == 0);
+  assert_equalsf(cik_v3_length(cik_v3_sub(positions[3], target)), 0.0f, 1e-3f);
+
+  for (i = 0; i < 3; ++i)
+  {
+    v3 rest_dir = cik_v3_normalize(cik_v3_sub(rest[i + 1], rest[i]));
+    v3 dir = cik_v3_normalize(cik_v3_sub(positions[i + 1], positions[i]));
+
+    assert_equalsf(cik_v3_length(cik_v3_sub(positions[i + 1], positions[i])), cik_v3_length(cik_v3_sub(rest[i + 1], rest[i])), 1e-2f);
+    assert(angles[i] >= hinge_min[i] && angles[i] <= hinge_max[i]);
+    assert_equalsf(angles[i], cik_atan2f_minimax15(cik_v3_cross(rest_dir, dir).z, cik_v3_dot(rest_dir, dir)), 1e-3f);
+  }
+
+  /* Targets just past the limit of bone 0 clamp to it, the last bone is locked straight */
+  hinge_min[0] = -1.13f;
+  hinge_max[0] = 1.13f;
+  hinge_min[1] = hinge_max[1] = 0.0f;
+
+  for (i = 0; i < 2; ++i)
+  {
+    float s, c;
+
+    cik_sincosf_precise((i == 0) ? 1.14f : 1.18f, &s, &c);
+
+    positions[0] = cik_v3(0.0f, 0.0f, 0.0f);
+    positions[1] = cik_v3(1.0f, 0.0f, 0.0f);
+    positions[2] = cik_v3(2.0f, 0.0f, 0.0f);
+    target = cik_v3(1.9f * c, 1.9f * s, 0.0f);
+
+    assert(cik_fabrik_solve_planar(positions, 3, target, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-4f, 8, angles) == 1);
+    assert_equalsf(angles[0], 1.13f, 1e-4f);
+    assert_equalsf(cik_atan2f_minimax15(positions[1].y, positions[1].x), 1.13f, 1e-4f);
+  }
+
+  /* Mixed axes are not planar */
+  hinge_axes[1] = cik_v3(1.0f, 0.0f, 0.0f);
+  assert(cik_fabrik_solve_planar(positions, 4, target, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, angles) == 2);
+}
+
+void cik_test_fabrik_solve_scratch(void)
+{
+#define LONG_JOINTS (CIK_MAX_JOINTS + 72)
+
+  static float scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(LONG_JOINTS)];
+  static v3 positions[LONG_JOINTS];
+  static float max_angles[LONG_JOINTS - 1];
+  static int hinge_types[LONG_JOINTS - 1];
+  static v3 hinge_axes[LONG_JOINTS - 1];
+  static float hinge_min[LONG_JOINTS - 1];
+  static float hinge_max[LONG_JOINTS - 1];
+  static float x[LONG_JOINTS], y[LONG_JOINTS], z[LONG_JOINTS];
+  v3 target = cik_v3(10.0f, 10.0f, 5.0f);
+  int results[1];
+  int i, w;
+
+  assert(cik_fabrik_scratch_size(LONG_JOINTS) <= sizeof(scratch));
+  assert(cik_fabrik_batch_scratch_size(LONG_JOINTS) == sizeof(scratch));
+  assert(cik_fabrik_scratch_size(1) == 0);
+
+  for (i = 0; i < LONG_JOINTS; ++i)
+  {
+    positions[i] = cik_v3(0.25f * (float)i, 0.0f, 0.0f);
+  }
+
+  for (i = 0; i < LONG_JOINTS - 1; ++i)
+  {
+    max_angles[i] = CIK_PI;
+    hinge_types[i] = 0;
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -CIK_PI;
+    hinge_max[i] = CIK_PI;
+  }
+
+  /* Every solver without scratch memory takes chains of up to CIK_MAX_JOINTS, the planar one
+   * with all bones as Z hinges
+   */
+  for (w = 0; w < 6; ++w)
+  {
+    int code = 2;
+
+    for (i = 0; i < CIK_MAX_JOINTS; ++i)
+    {
+      positions[i] = cik_v3(0.25f * (float)i, 0.0f, 0.0f);
+      x[i] = positions[i].x;
+      y[i] = z[i] = 0.0f;
+    }
+
+    for (i = 0; i < CIK_MAX_JOINTS - 1; ++i)
+    {
+      hinge_types[i] = (w == 2);
+    }
+
+    switch (w)
+    {
+    case 0:
+      code = cik_fabrik_solve(positions, CIK_MAX_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16);
+      break;
+    case 1:
+      code = cik_fabrik_solve_ex(positions, CIK_MAX_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16, 0);
+      break;
+    case 2:
+      code = cik_fabrik_solve_planar(positions, CIK_MAX_JOINTS, target, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16, 0);
+      break;
+    case 3:
+      code = cik_ccd_solve(positions, CIK_MAX_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16);
+      break;
+    case 4:
+      code = cik_dls_solve(positions, CIK_MAX_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16);
+      break;
+    default:
+      cik_fabrik_solve_batch(
+          x, y, z, CIK_MAX_JOINTS, 1, &target.x, &target.y, &target.z,
+          max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+          1e-2f, 16, results);
+      code = results[0];
+      break;
+    }
+
+    assert(code != 2);
+  }
+
+  for (i = 0; i < LONG_JOINTS; ++i)
+  {
+    positions[i] = cik_v3(0.25f * (float)i, 0.0f, 0.0f);
+  }
+
+  /* Longer chains are only accepted by the scratch variants */
+  assert(cik_fabrik_solve(positions, LONG_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16) == 2);
+  assert(cik_fabrik_solve_scratch(positions, LONG_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 32, scratch) == 0);
+  assert_equalsf(cik_v3_length(cik_v3_sub(positions[LONG_JOINTS - 1], target)), 0.0f, 1e-2f);
+
+  /* Missing scratch memory is invalid input */
+  assert(cik_fabrik_solve_scratch(positions, LONG_JOINTS, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-2f, 16, 0) == 2);
+
+  /* The batch solver reuses the same memory, one chain per call */
+  for (i = 0; i < LONG_JOINTS; ++i)
+  {
+    x[i] = 0.25f * (float)i;
+    y[i] = z[i] = 0.0f;
+  }
+
+  cik_fabrik_solve_batch(
+      x, y, z, LONG_JOINTS, 1, &target.x, &target.y, &target.z,
+      max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+      1e-2f, 32, results);
+
+  assert(results[0] == 2);
+
+  cik_fabrik_solve_batch_scratch(
+      x, y, z, LONG_JOINTS, 1, &target.x, &target.y, &target.z,
+      max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+      1e-2f, 32, results, scratch);
+
+  assert(results[0] == 0);
+  assert_equalsf(x[LONG_JOINTS - 1], target.x, 1e-2f);
+
+#undef LONG_JOINTS
+}
+
+void cik_test_fabrik_solve_ex(void)
+{
+  v3 positions[4];
+  v3 hinge_axes[3];
+  v3 target = cik_v3(1.0f, 2.0f, 0.5f);
+  int hinge_types[3] = {0, 0, 0};
+  float max_angles[3] = {0.6f, 0.6f, 0.6f};
+  float hinge_min[3] = {0.0f, 0.0f, 0.0f};
+  float hinge_max[3] = {0.0f, 0.0f, 0.0f};
+  float trajectory[32];
+  cik_solve_info info;
+  int code, i;
+
+  for (i = 0; i < 4; ++i)
+  {
+    positions[i] = cik_v3((float)i, 0.0f, 0.0f);
+  }
+
+  hinge_axes[0] = hinge_axes[1] = hinge_axes[2] = cik_v3(0.0f, 0.0f, 1.0f);
+
+  info.trajectory = trajectory;
+  info.trajectory_capacity = 32;
+
+  /* The cones are too tight to reach the target, the error shrinks until the solve stalls */
+  code = cik_fabrik_solve_ex(positions, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, &info);
+
+  assert(code == 1);
+  assert(info.stalled == 1);
+  assert(info.iterations >= 1 && info.iterations <= 32);
+  assert(info.trajectory_count == info.iterations);
+  assert(info.cone_active > 0);
+  assert(info.hinge_active == 0);
+  assert_equalsf(info.error, cik_v3_length(cik_v3_sub(positions[3], target)), 1e-2f);
+  assert_equalsf(trajectory[info.trajectory_count - 1], info.error, 1e-5f);
+
+  for (i = 1; i < info.trajectory_count; ++i)
+  {
+    assert(trajectory[i] <= trajectory[i - 1]);
+  }
+
+  /* Without the cones it converges, the trajectory keeps the first trajectory_capacity entries */
+  for (i = 0; i < 4; ++i)
+  {
+    positions[i] = cik_v3((float)i, 0.0f, 0.0f);
+  }
+
+  max_angles[0] = max_angles[1] = max_angles[2] = CIK_PI;
+
+  info.trajectory_capacity = 2;
+
+  code = cik_fabrik_solve_ex(positions, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, &info);
+
+  assert(code == 0);
+  assert(info.stalled == 0);
+  assert(info.iterations > 2 && info.iterations <= 32);
+  assert(info.trajectory_count == 2);
+  assert(info.cone_active == 0);
+  assert(info.error <= 1e-3f);
+  assert(trajectory[1] < trajectory[0]);
+
+  /* Unreachable targets report the distance left after stretching */
+  code = cik_fabrik_solve_ex(positions, 4, cik_v3(10.0f, 0.0f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, &info);
+
+  assert(code == 3);
+  assert(info.iterations == 0);
+  assert_equalsf(info.error, 7.0f, 5e-2f);
+}
+
+void cik_test_fabrik_step(void)
+{
+  float scratch_a[CIK_FABRIK_SCRATCH_FLOATS(4)];
+  float scratch_b[CIK_FABRIK_SCRATCH_FLOATS(4)];
+  cik_chain chain_a, chain_b;
+  cik_fabrik_state state;
+  cik_solve_info info;
+  v3 stepped[4], solved[4];
+  v3 hinge_axes[3];
+  v3 target = cik_v3(1.0f, 2.0f, 0.5f);
+  int hinge_types[3] = {0, 1, 0};
+  float max_angles[3] = {1.0f, 1.0f, 1.0f};
+  float hinge_min[3] = {-1.0f, -1.0f, -1.0f};
+  float hinge_max[3] = {1.0f, 1.0f, 1.0f};
+  int i, steps = 0, code;
+
+  hinge_axes[0] = hinge_axes[1] = hinge_axes[2] = cik_v3(0.0f, 0.0f, 1.0f);
+
+  for (i = 0; i < 4; ++i)
+  {
+    stepped[i] = solved[i] = cik_v3((float)i, (i == 2) ? 0.1f : 0.0f, 0.0f);
+  }
+
+  assert(cik_chain_init(&chain_a, scratch_a, stepped, 4, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert(cik_chain_init(&chain_b, scratch_b, solved, 4, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+
+  info.trajectory = 0;
+  code = cik_chain_solve_ex(&chain_b, solved, target, 1e-3f, 32, &info);
+
+  /* Stepping one iteration at a time gives exactly the same solve, the pose is valid in between */
+  assert(cik_fabrik_begin(&state, &chain_a, stepped, target, 1e-3f, 32, 0) == 0);
+
+  while (!cik_fabrik_step(&state))
+  {
+    steps++;
+    assert_equalsf(cik_v3_length(cik_v3_sub(stepped[1], stepped[0])), chain_a.lengths[0], 1e-2f);
+  }
+
+  assert(cik_fabrik_end(&state) == code);
+  assert(steps + 1 == info.iterations);
+  assert(state.iterations == info.iterations);
+
+  for (i = 0; i < 4; ++i)
+  {
+    assert_equalsf(stepped[i].x, solved[i].x, 1e-6f);
+    assert_equalsf(stepped[i].y, solved[i].y, 1e-6f);
+    assert_equalsf(stepped[i].z, solved[i].z, 1e-6f);
+  }
+
+  /* Unreachable targets finish in cik_fabrik_begin */
+  assert(cik_fabrik_begin(&state, &chain_a, stepped, cik_v3(9.0f, 0.0f, 0.0f), 1e-3f, 32, 0) == 1);
+  assert(cik_fabrik_step(&state) == 1);
+  assert(cik_fabrik_end(&state) == 3);
+}
+
+static double cik_test_clock_ns;
+
+/* Deterministic clock: every read advances time by 100ns */
+double cik_test_clock(void)
+{
+  cik_test_clock_ns += 100.0;
+  return cik_test_clock_ns;
+}
+
+void cik_test_fabrik_schedule(void)
+{
+#define JOBS 4
+
+  static float scratch[JOBS][CIK_FABRIK_SCRATCH_FLOATS(5)];
+  cik_chain chains[JOBS];
+  cik_fabrik_job jobs[JOBS];
+  cik_fabrik_budget budget;
+  v3 positions[JOBS][5];
+  v3 hinge_axes[4];
+  int hinge_types[4] = {0, 0, 0, 0};
+  float max_angles[4] = {CIK_PI, CIK_PI, CIK_PI, CIK_PI};
+  float hinge_min[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float hinge_max[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  int heap[JOBS];
+  int i, j, spent;
+
+  hinge_axes[0] = hinge_axes[1] = hinge_axes[2] = hinge_axes[3] = cik_v3(0.0f, 0.0f, 1.0f);
+
+  for (j = 0; j < JOBS; ++j)
+  {
+    for (i = 0; i < 5; ++i)
+    {
+      positions[j][i] = cik_v3((float)i, (i == 2) ? 0.1f : 0.0f, 0.0f);
+    }
+
+    assert(cik_chain_init(&chains[j], scratch[j], positions[j], 5, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+
+    jobs[j].chain = &chains[j];
+    jobs[j].pos = positions[j];
+    jobs[j].tolerance = 1e-3f;
+    jobs[j].max_iter = 64;
+  }
+
+  /* Job 1 is the furthest from its target, job 3 is unreachable */
+  jobs[0].target = cik_v3(3.5f, 0.5f, 0.0f);
+  jobs[1].target = cik_v3(0.5f, 2.5f, 0.5f);
+  jobs[2].target = cik_v3(3.0f, 1.0f, 0.0f);
+  jobs[3].target = cik_v3(0.0f, 9.0f, 0.0f);
+
+  /* An iteration budget is spent on the largest error first */
+  budget.iterations = 1;
+  budget.nanoseconds = 0.0;
+  budget.now_ns = 0;
+
+  spent = cik_fabrik_schedule(jobs, JOBS, &budget, heap);
+
+  assert(spent == 1);
+  assert(jobs[1].iterations == 1);
+  assert(jobs[0].iterations == 0 && jobs[2].iterations == 0);
+  assert(jobs[0].result == 1 && jobs[1].result == 1 && jobs[2].result == 1);
+  assert(jobs[3].result == 3);
+
+  /* Unlimited budget, every reachable job converges from its partial pose */
+  budget.iterations = 0;
+  spent = cik_fabrik_schedule(jobs, JOBS, &budget, heap);
+
+  assert(spent == jobs[0].iterations + jobs[1].iterations + jobs[2].iterations);
+
+  for (j = 0; j < 3; ++j)
+  {
+    assert(jobs[j].result == 0);
+    assert(jobs[j].error <= 1e-3f * 1.01f);
+  }
+
+  /* A time budget of 3 clock reads (the first one marks the start) allows 2 iterations */
+  jobs[0].target = cik_v3(1.0f, 3.0f, 0.0f);
+  jobs[1].target = cik_v3(1.0f, -3.0f, 0.0f);
+  jobs[2].target = cik_v3(-1.0f, 3.0f, 0.0f);
+
+  budget.nanoseconds = 250.0;
+  budget.now_ns = cik_test_clock;
+
+  spent = cik_fabrik_schedule(jobs, JOBS, &budget, heap);
+
+  assert(spent == 2);
+
+#undef JOBS
+}
+
+void cik_test_fabrik_solve_tree(void)
+{
+  /* Torso with two arms and a head:
+   *
+   *   head 9
+   *   |
+   *   chest 2 - 3 - 4 - 5 left hand
+   *   |     \
+   *   1      6 - 7 - 8 right hand
+   *   |
+   *   pelvis 0 (root)
+   */
+#define TREE_JOINTS 10
+
+  int parent[TREE_JOINTS] = {-1, 0, 1, 2, 3, 4, 2, 6, 7, 2};
+  v3 pos[TREE_JOINTS];
+  v3 start[TREE_JOINTS];
+  int effectors[3] = {5, 8, 9};
+  v3 targets[3];
+  float max_angles[TREE_JOINTS - 1];
+  int hinge_types[TREE_JOINTS - 1];
+  v3 hinge_axes[TREE_JOINTS - 1];
+  float hinge_min[TREE_JOINTS - 1];
+  float hinge_max[TREE_JOINTS - 1];
+  float scratch[CIK_FABRIK_TREE_SCRATCH_FLOATS(TREE_JOINTS)];
+  cik_solve_info info;
+  int i, e;
+
+  start[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  start[1] = cik_v3(0.0f, 1.0f, 0.0f);
+  start[2] = cik_v3(0.0f, 2.0f, 0.0f);
+  start[3] = cik_v3(-1.0f, 2.0f, 0.0f);
+  start[4] = cik_v3(-2.0f, 2.0f, 0.0f);
+  start[5] = cik_v3(-3.0f, 2.0f, 0.0f);
+  start[6] = cik_v3(1.0f, 2.0f, 0.0f);
+  start[7] = cik_v3(2.0f, 2.0f, 0.0f);
+  start[8] = cik_v3(3.0f, 2.0f, 0.0f);
+  start[9] = cik_v3(0.0f, 3.0f, 0.0f);
+
+  for (i = 0; i < TREE_JOINTS; ++i)
+  {
+    pos[i] = start[i];
+  }
+
+  for (i = 0; i < TREE_JOINTS - 1; ++i)
+  {
+    max_angles[i] = CIK_PI * 0.9f;
+    hinge_types[i] = 0;
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_min[i] = -CIK_PI_HALF;
+    hinge_max[i] = CIK_PI_HALF;
+  }
+
+  targets[0] = cik_v3(-2.0f, 3.5f, 1.0f);
+  targets[1] = cik_v3(2.5f, 1.0f, 0.5f);
+  targets[2] = cik_v3(0.3f, 2.9f, 0.2f);
+
+  assert(cik_fabrik_tree_scratch_size(TREE_JOINTS) == sizeof(scratch));
+
+  info.trajectory = 0;
+
+  assert(cik_fabrik_solve_tree(
+             pos, parent, TREE_JOINTS, effectors, targets, 3,
+             max_angles, hinge_types, hinge_axes, hinge_min, hinge_max,
+             1e-3f, 64, scratch, &info) == 0);
+
+  /* Every effector reached, root pinned and all bone lengths kept */
+  for (e = 0; e < 3; ++e)
+  {
+    assert(cik_v3_length(cik_v3_sub(pos[effectors[e]], targets[e])) <= 1e-3f);
+  }
+
+  assert(info.error <= 1e-3f);
+  assert(info.iterations > 0);
+  assert(pos[0].x == 0.0f && pos[0].y == 0.0f && pos[0].z == 0.0f);
+
+  for (i = 1; i < TREE_JOINTS; ++i)
+  {
+    assert_equalsf(cik_v3_length(cik_v3_sub(pos[i], pos[parent[i]])), cik_v3_length(cik_v3_sub(start[i], start[parent[i]])), 1e-3f);
+  }
+
+  /* A serial chain is a tree with a single effector */
+  {
+    int chain_parent[3] = {-1, 0, 1};
+    v3 chain_pos[3];
+    v3 target = cik_v3(1.2f, 1.0f, 0.0f);
+    int end = 2;
+
+    chain_pos[0] = cik_v3(0.0f, 0.0f, 0.0f);
+    chain_pos[1] = cik_v3(1.0f, 0.1f, 0.0f);
+    chain_pos[2] = cik_v3(2.0f, 0.0f, 0.0f);
+
+    assert(cik_fabrik_solve_tree(chain_pos, chain_parent, 3, &end, &target, 1, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, scratch, 0) == 0);
+    assert(cik_v3_length(cik_v3_sub(chain_pos[2], target)) <= 1e-3f);
+  }
+
+  /* Invalid input */
+  parent[3] = 5;
+  assert(cik_fabrik_solve_tree(pos, parent, TREE_JOINTS, effectors, targets, 3, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64, scratch, 0) == 2);
+  parent[3] = 2;
+  effectors[0] = 0;
+  assert(cik_fabrik_solve_tree(pos, parent, TREE_JOINTS, effectors, targets, 3, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64, scratch, 0) == 2);
+  effectors[0] = 5;
+  assert(cik_fabrik_solve_tree(pos, parent, TREE_JOINTS, effectors, targets, 3, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64, 0, 0) == 2);
+
+#undef TREE_JOINTS
+}
+
+void cik_test_ccd_solve(void)
+{
+  /* Hinges on alternating axes with tight limits, not planar so FABRIK has no joint-angle path */
+  v3 rest[5];
+  v3 positions[5];
+  v3 hinge_axes[4];
+  int hinge_types[4] = {1, 1, 1, 1};
+  float hinge_min[4] = {-0.5f, -0.5f, -0.3f, -0.5f};
+  float hinge_max[4] = {0.5f, 0.5f, 0.6f, 0.5f};
+  float pose_angles[4] = {0.3f, -0.4f, 0.2f, 0.45f};
+  v3 target = cik_v3(0.0f, 0.0f, 0.0f);
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(5)];
+  cik_chain chain;
+  cik_solve_info info;
+  int i, pass;
+
+  for (i = 0; i < 5; ++i)
+  {
+    rest[i] = cik_v3((float)i, 0.0f, 0.0f);
+  }
+
+  /* Target from a pose inside the limits */
+  for (i = 0; i < 4; ++i)
+  {
+    float c = cik_cosf(pose_angles[i]);
+    float s = cik_sinf(pose_angles[i]);
+
+    hinge_axes[i] = (i % 2) ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+    target = cik_v3_add(target, (i % 2) ? cik_v3(c, 0.0f, -s) : cik_v3(c, s, 0.0f));
+  }
+
+  for (pass = 0; pass < 2; ++pass)
+  {
+    for (i = 0; i < 5; ++i)
+    {
+      positions[i] = rest[i];
+    }
+
+    if (pass == 0)
+    {
+      assert(cik_ccd_solve(positions, 5, target, 0, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 0);
+      assert(cik_v3_length(cik_v3_sub(positions[4], target)) <= 1e-3f);
+    }
+    else
+    {
+      /* Unreachable targets keep the limits too */
+      assert(cik_ccd_solve(positions, 5, cik_v3(2.0f, 6.0f, -3.0f), 0, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 3);
+    }
+
+    /* Every hinge stays in its plane and inside its limits */
+    for (i = 0; i < 4; ++i)
+    {
+      v3 dir = cik_v3_normalize(cik_v3_sub(positions[i + 1], positions[i]));
+      v3 side = cik_v3_cross(hinge_axes[i], cik_v3(1.0f, 0.0f, 0.0f));
+      float mid = 0.5f * (hinge_min[i] + hinge_max[i]);
+      float half = 0.5f * (hinge_max[i] - hinge_min[i]);
+
+      assert_equalsf(cik_v3_length(cik_v3_sub(positions[i + 1], positions[i])), cik_v3_length(cik_v3_sub(rest[i + 1], rest[i])), 1e-2f);
+      assert(cik_fabsf(cik_v3_dot(dir, hinge_axes[i])) < 1e-3f);
+
+      /* Angle to the middle of the range, compared without atan2 */
+      assert(dir.x * cik_cosf(mid) + cik_v3_dot(dir, side) * cik_sinf(mid) >= cik_cosf(half) - 1e-3f);
+    }
+  }
+
+  /* Chain API with exactly sized scratch memory and statistics */
+  for (i = 0; i < 5; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  info.trajectory = 0;
+  assert(cik_chain_init(&chain, scratch, rest, 5, 0, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert(cik_chain_solve_ccd_ex(&chain, positions, target, 1e-3f, 64, &info) == 0);
+  assert(info.iterations > 0 && info.error <= 1e-3f);
+
+  /* Invalid input */
+  assert(cik_ccd_solve(positions, 1, target, 0, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 2);
+}
+
+void cik_test_dls_solve(void)
+{
+  v3 rest[5];
+  v3 positions[5];
+  v3 hinge_axes[4];
+  int hinge_types[4] = {0, 0, 0, 0};
+  float max_angles[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  float hinge_min[4] = {-0.5f, -0.5f, -0.3f, -0.5f};
+  float hinge_max[4] = {0.5f, 0.5f, 0.6f, 0.5f};
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(5)];
+  cik_chain chain;
+  cik_solve_info info;
+  cik_dls_cache cache;
+  v3 target = cik_v3(3.0f, 1.2f, 0.6f);
+  int i, frame, iterations = 0, builds = 0;
+
+  for (i = 0; i < 5; ++i)
+  {
+    rest[i] = cik_v3((float)i, 0.0f, 0.0f);
+    positions[i] = rest[i];
+  }
+
+  for (i = 0; i < 4; ++i)
+  {
+    hinge_axes[i] = (i % 2) ? cik_v3(0.0f, 1.0f, 0.0f) : cik_v3(0.0f, 0.0f, 1.0f);
+  }
+
+  info.trajectory = 0;
+  cik_dls_cache_reset(&cache);
+  assert(cik_chain_init(&chain, scratch, rest, 5, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+
+  /* The hybrid solver moves the chain into place */
+  assert(cik_chain_solve_hybrid_ex(&chain, positions, target, 0.1f, 1e-4f, 64, &cache, &info) == 0);
+  assert(info.error <= 1e-4f);
+
+  /* A target moving in small steps converges in one or two steps, mostly on the cached factorization */
+  for (frame = 0; frame < 20; ++frame)
+  {
+    target = cik_v3_add(target, cik_v3(0.002f, -0.001f, 0.0015f));
+
+    assert(cik_chain_solve_dls_ex(&chain, positions, target, 1e-4f, 8, &cache, &info) == 0);
+    assert(info.iterations <= 2 && info.error <= 1e-4f);
+
+    iterations += info.iterations;
+    builds += info.jacobian_builds;
+  }
+
+  assert(builds < iterations);
+
+  for (i = 0; i < 4; ++i)
+  {
+    assert_equalsf(cik_v3_length(cik_v3_sub(positions[i + 1], positions[i])), cik_v3_length(cik_v3_sub(rest[i + 1], rest[i])), 1e-2f);
+  }
+
+  /* Hinges with limits through the fixed array API, the CCD test target is inside the limits */
+  for (i = 0; i < 4; ++i)
+  {
+    hinge_types[i] = 1;
+    positions[i] = rest[i];
+  }
+
+  positions[4] = rest[4];
+  target = cik_v3(3.7567f, 0.4942f, -0.0456f);
+
+  assert(cik_dls_solve(positions, 5, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 0);
+  assert(cik_v3_length(cik_v3_sub(positions[4], target)) <= 1e-3f);
+  assert(cik_dls_solve(positions, 5, cik_v3(2.0f, 6.0f, -3.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 3);
+
+  /* Invalid input */
+  assert(cik_dls_solve(positions, 1, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 2);
+}
+
+void cik_test_constraint_tables(void)
+{
+  cik_constraint c;
+  v3 axis = cik_v3(0.0f, 0.0f, 1.0f);
+  v3 parent = cik_v3(1.0f, 2.0f, 3.0f);
+  v3 child;
+  float s, co;
+
+  /* The compiled limits are far more accurate than the LUT */
+  cik_sincosf_precise(0.8f, &s, &co);
+  assert_equalsf(s, 0.7173561f, 1e-6f);
+  assert_equalsf(co, 0.6967067f, 1e-6f);
+  cik_sincosf_precise(-2.5f, &s, &co);
+  assert_equalsf(s, -0.5984721f, 1e-6f);
+  assert_equalsf(co, -0.8011436f, 1e-6f);
+
+  /* Hinge: out of plane and past the max limit lands exactly on the limit */
+  cik_constraint_compile(&c, cik_v3(1.0f, 0.0f, 0.0f), 1, 0.0f, axis, -0.5f, 0.8f);
+  child = cik_v3_add(parent, cik_v3(0.0f, 2.0f, 0.5f));
+  assert(cik_constraint_enforce_hinge(&c, parent, &child) == 1);
+  child = cik_v3_sub(child, parent);
+  assert(cik_fabsf(child.z) < 1e-5f);
+  assert_equalsf(child.y / child.x, 1.0296386f, 1e-5f);
+
+  /* Inside the limits only the plane projection applies */
+  child = cik_v3_add(parent, cik_v3(1.0f, -0.2f, 0.0f));
+  assert(cik_constraint_enforce_hinge(&c, parent, &child) == 0);
+  assert_equalsf(child.y - parent.y, -0.2f, 1e-3f);
+
+  /* Cone: the clamped bone keeps its length and lies on the cone */
+  cik_constraint_compile(&c, cik_v3(0.0f, 1.0f, 0.0f), 0, 0.8f, axis, 0.0f, 0.0f);
+  child = cik_v3_add(parent, cik_v3(3.0f, 0.0f, 0.0f));
+  assert(cik_constraint_enforce_cone(&c, parent, &child) == 1);
+  child = cik_v3_sub(child, parent);
+  assert_equalsf(cik_v3_length(child), 3.0f, 1e-2f);
+  assert_equalsf(child.y / cik_v3_length(child), 0.6967067f, 1e-3f);
+
+  /* A bone exactly opposite to the rest direction still gets clamped */
+  child = cik_v3_add(parent, cik_v3(0.0f, -1.0f, 0.0f));
+  assert(cik_constraint_enforce_cone(&c, parent, &child) == 1);
+  assert_equalsf(child.y - parent.y, 0.6967067f, 1e-2f);
+}
+
+void cik_test_math_tiers(void)
+{
+  /* sin(2.5), sin(-4), atan2(-1, -3), 1/sqrt(7) */
+  assert_equalsf(cik_sinf_lut(2.5f), 0.5984721f, 2e-4f);
+  assert_equalsf(cik_sinf_minimax7(2.5f), 0.5984721f, 2e-6f);
+  assert_equalsf(cik_sinf_minimax9(2.5f), 0.5984721f, 3e-7f);
+  assert_equalsf(cik_sinf_minimax9(-4.0f), 0.7568025f, 3e-7f);
+  assert_equalsf(cik_atan2f_minimax11(-1.0f, -3.0f), -2.8198421f, 2e-5f);
+  assert_equalsf(cik_atan2f_minimax15(-1.0f, -3.0f), -2.8198421f, 1e-6f);
+  assert_equalsf(cik_atan2f_minimax15(2.0f, 0.0f), CIK_PI_HALF, 1e-6f);
+  assert_equalsf(cik_atan2f_minimax15(0.0f, 0.0f), 0.0f, 1e-6f);
+  assert_equalsf(cik_invsqrt_steps(7.0f, 3), 0.3779645f, 1e-6f);
+
+  /* Bit punning and the lane 1 / sqrt, which must match cik_invsqrt exactly */
+  {
+    float in[7] = {0.0f, 1e-6f, 0.25f, 1.0f, 2.0f, 7.0f, 1e6f};
+    float out[7];
+    int i;
+
+    assert(cik_float_bits(1.0f) == 0x3f800000);
+    assert(cik_bits_float(0x40000000) == 2.0f);
+
+    cik_invsqrt_lanes(in, out, 7);
+
+    for (i = 0; i < 7; ++i)
+    {
+      assert(out[i] == cik_invsqrt(in[i]));
+    }
+  }
+}
+
+void cik_test_fabrik_stall(void)
+{
+  v3 positions[5];
+  v3 hinge_axes[4];
+  int hinge_types[4] = {0, 0, 0, 0};
+  float max_angles[4] = {0.3f, 0.3f, 0.3f, 0.3f};
+  float hinge_min[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float hinge_max[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float trajectory[64];
+  cik_solve_info info;
+  int i;
+
+  for (i = 0; i < 5; ++i)
+  {
+    positions[i] = cik_v3((float)i, 0.0f, 0.0f);
+  }
+
+  for (i = 0; i < 4; ++i)
+  {
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+  }
+
+  /* Within reach but behind the cone limits: stops after a few iterations instead of 64 */
+  info.trajectory = trajectory;
+  info.trajectory_capacity = 64;
+  assert(cik_fabrik_solve_ex(positions, 5, cik_v3(-1.0f, 2.5f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64, &info) == 1);
+  assert(info.stalled == 1);
+  assert(info.iterations < 16);
+  assert(info.error > 0.5f);
+
+  /* Inside the minimum reach: bones 3, 1 and 1 cannot bring the end closer than 1 to the root */
+  positions[0] = cik_v3(0.0f, 0.0f, 0.0f);
+  positions[1] = cik_v3(3.0f, 0.0f, 0.0f);
+  positions[2] = cik_v3(4.0f, 0.0f, 0.0f);
+  positions[3] = cik_v3(5.0f, 0.0f, 0.0f);
+  max_angles[0] = max_angles[1] = max_angles[2] = CIK_PI;
+  assert(cik_fabrik_solve(positions, 4, cik_v3(0.5f, 0.2f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 64) == 4);
+  assert_equalsf(positions[3].x, 5.0f, 1e-6f);
+
+  /* On the minimum reach it is still solved */
+  assert(cik_fabrik_solve(positions, 4, cik_v3(0.0f, 1.2f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 256) != 4);
+}
+
+void cik_test_fabrik_momentum(void)
+{
+  v3 positions[16];
+  v3 hinge_axes[15];
+  int hinge_types[15];
+  float max_angles[15];
+  float hinge_min[15];
+  float hinge_max[15];
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(16)];
+  float plain_error;
+  cik_chain chain;
+  cik_solve_info info;
+  int i, max_iter;
+
+  for (i = 0; i < 15; ++i)
+  {
+    hinge_axes[i] = cik_v3(0.0f, 0.0f, 1.0f);
+    hinge_types[i] = 0;
+    max_angles[i] = 1.0f;
+    hinge_min[i] = hinge_max[i] = 0.0f;
+  }
+
+  for (i = 0; i < 16; ++i)
+  {
+    positions[i] = cik_v3((float)i, 0.0f, 0.0f);
+  }
+
+  /* Long constrained chain: plain FABRIK stalls far from the target */
+  info.trajectory = 0;
+  assert(cik_chain_init(&chain, scratch, positions, 16, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert(chain.flags == 0);
+  cik_chain_solve_ex(&chain, positions, cik_v3(12.0f, 5.0f, 0.0f), 1e-3f, 64, &info);
+  plain_error = info.error;
+  assert(plain_error > 0.5f);
+
+  /* Momentum carries the correction down the chain before it stalls */
+  for (i = 0; i < 16; ++i)
+  {
+    positions[i] = cik_v3((float)i, 0.0f, 0.0f);
+  }
+
+  chain.flags = CIK_FABRIK_MOMENTUM;
+  cik_chain_solve_ex(&chain, positions, cik_v3(12.0f, 5.0f, 0.0f), 1e-3f, 64, &info);
+  assert(info.error < 0.1f);
+
+  for (i = 0; i < 15; ++i)
+  {
+    assert_equalsf(cik_v3_length(cik_v3_sub(positions[i + 1], positions[i])), 1.0f, 1e-2f);
+  }
+
+  /* Rejected steps count as iterations but never run past max_iter */
+  for (max_iter = 1; max_iter <= 24; ++max_iter)
+  {
+    for (i = 0; i < 16; ++i)
+    {
+      positions[i] = cik_v3((float)i, 0.0f, 0.0f);
+    }
+
+    cik_chain_solve_ex(&chain, positions, cik_v3(12.0f, 5.0f, 0.0f), 1e-3f, max_iter, &info);
+    assert(info.iterations <= max_iter);
+  }
+
+  /* Without limits the rejected steps fall back to plain sweeps and it still converges */
+  for (i = 0; i < 15; ++i)
+  {
+    max_angles[i] = CIK_PI;
+  }
+
+  cik_chain_compile(&chain);
+  assert(cik_chain_solve_ex(&chain, positions, cik_v3(8.0f, 5.0f, 0.0f), 1e-3f, 64, &info) == 0);
+  assert(info.error <= 1e-3f);
+}
+
+void cik_test_fabrik_constrain_forward(void)
+{
+  /* Excavator arm (hinges around z) on a turret swinging around y */
+  v3 rest[5] = {{0.0f, 0.0f, 0.0f}, {0.5f, 0.0f, 0.0f}, {1.5f, 1.0f, 0.0f}, {3.5f, 0.5f, 0.0f}, {4.5f, 0.0f, 0.0f}};
+  v3 positions[5];
+  v3 hinge_axes[4] = {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}};
+  int hinge_types[4] = {1, 1, 1, 1};
+  float max_angles[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float hinge_min[4] = {-1.5f, -CIK_PI_QUARTER, 0.0f, -CIK_PI_HALF};
+  float hinge_max[4] = {1.5f, CIK_PI_QUARTER, CIK_PI * 0.75f, CIK_PI_HALF};
+  float angles[4] = {0.2f, 0.0f, 0.3f, 1.3f};
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(5)];
+  cik_chain chain;
+  cik_solve_info info;
+  v3 target = rest[0];
+  int i;
+
+  /* Target of a pose within the limits */
+  for (i = 0; i < 4; ++i)
+  {
+    v3 bone = cik_v3_sub(rest[i + 1], rest[i]);
+    v3 dir = cik_v3_normalize(bone);
+
+    dir = cik_v3_add(cik_v3_scale(dir, cik_cosf(angles[i])), cik_v3_scale(cik_v3_cross(hinge_axes[i], dir), cik_sinf(angles[i])));
+    target = cik_v3_add(target, cik_v3_scale(dir, cik_v3_length(bone)));
+  }
+
+  /* Only the backward pass constrained: stalls short of the target */
+  info.trajectory = 0;
+
+  for (i = 0; i < 5; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  assert(cik_chain_init(&chain, scratch, positions, 5, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 32, &info) == 1);
+  assert(info.error > 0.05f);
+
+  /* Both passes constrained: reaches it within the limits */
+  for (i = 0; i < 5; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  chain.flags = CIK_FABRIK_CONSTRAIN_FORWARD;
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 32, &info) == 0);
+
+  for (i = 0; i < 4; ++i)
+  {
+    assert(cik_chain_bone_valid(&chain, i, positions[i], positions[i + 1]));
+    assert_equalsf(cik_v3_length(cik_v3_sub(positions[i + 1], positions[i])), cik_v3_length(cik_v3_sub(rest[i + 1], rest[i])), 1e-2f);
+  }
+}
+
+/* Bones 0 and 2 spherical, bone 1 a hinge */
+CIK_DEFINE_FABRIK_SOLVER(cik_test_solve_arm4, 4, 0x2)
+
+void cik_test_fabrik_specialized(void)
+{
+  v3 rest[4] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.3f, 0.0f}, {2.0f, 0.0f, 0.0f}, {3.0f, 0.3f, 0.0f}};
+  v3 generic[4];
+  v3 unrolled[4];
+  v3 hinge_axes[3] = {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}};
+  int hinge_types[3] = {0, 1, 0};
+  float max_angles[3] = {0.8f, 0.8f, 0.8f};
+  float hinge_min[3] = {-1.5f, -1.5f, -1.5f};
+  float hinge_max[3] = {1.5f, 1.5f, 1.5f};
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(4)];
+  float scratch_short[CIK_FABRIK_SCRATCH_FLOATS(3)];
+  cik_chain chain;
+  cik_chain chain_short;
+  int i, k;
+
+  assert(cik_chain_init(&chain, scratch, rest, 4, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+
+  /* Same operations in the same order as the generic solver, so the poses match exactly,
+   * the second half with constrained forward passes
+   */
+  for (k = 0; k < 32; ++k)
+  {
+    v3 target = cik_v3(1.5f + 0.1f * (float)(k & 15), 1.0f - 0.1f * (float)(k & 15), 0.3f * cik_sinf((float)k));
+
+    chain.flags = k < 16 ? 0 : CIK_FABRIK_CONSTRAIN_FORWARD;
+
+    for (i = 0; i < 4; ++i)
+    {
+      generic[i] = unrolled[i] = rest[i];
+    }
+
+    assert(cik_chain_solve(&chain, generic, target, 1e-3f, 32) == cik_test_solve_arm4(&chain, unrolled, target, 1e-3f, 32));
+
+    for (i = 0; i < 4; ++i)
+    {
+      assert(generic[i].x == unrolled[i].x && generic[i].y == unrolled[i].y && generic[i].z == unrolled[i].z);
+    }
+  }
+
+  /* Unreachable, wrong joint count and hinge types that do not match the mask */
+  assert(cik_test_solve_arm4(&chain, unrolled, cik_v3(10.0f, 0.0f, 0.0f), 1e-3f, 32) == 3);
+  assert(cik_chain_init(&chain_short, scratch_short, rest, 3, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert(cik_test_solve_arm4(&chain_short, unrolled, cik_v3(1.0f, 1.0f, 0.0f), 1e-3f, 32) == 2);
+  assert(cik_chain_hinge_mask(&chain) == 0x2);
+
+  hinge_types[2] = 1;
+  assert(cik_chain_init(&chain, scratch, rest, 4, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  assert(cik_test_solve_arm4(&chain, unrolled, cik_v3(1.5f, 1.0f, 0.0f), 1e-3f, 32) == 2);
+}
+
+void cik_test_fabrik_multistart(void)
+{
+  v3 rest[4] = {{0.0f, 0.0f, 0.0f}, {0.9f, 0.3f, 0.0f}, {1.8f, 0.0f, 0.0f}, {2.7f, 0.3f, 0.0f}};
+  v3 single[4];
+  v3 multi[4];
+  v3 hinge_axes[3] = {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f}};
+  int hinge_types[3] = {0, 1, 0};
+  float max_angles[3] = {0.8f, 0.8f, 0.8f};
+  float hinge_min[3] = {-1.5f, -1.5f, -1.5f};
+  float hinge_max[3] = {1.5f, 1.5f, 1.5f};
+  float scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(4)];
+  v3 target = cik_v3(2.0f, -1.0f, 0.5f);
+  int i;
+
+  /* One start is the plain solve */
+  for (i = 0; i < 4; ++i)
+  {
+    single[i] = multi[i] = rest[i];
+  }
+
+  assert(cik_fabrik_solve(single, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32) == 1);
+  assert(cik_fabrik_solve_multistart(multi, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, 1, scratch) == 1);
+
+  for (i = 0; i < 4; ++i)
+  {
+    assert_equalsf(multi[i].x, single[i].x, 1e-4f);
+    assert_equalsf(multi[i].y, single[i].y, 1e-4f);
+    assert_equalsf(multi[i].z, single[i].z, 1e-4f);
+  }
+
+  /* A rotated start escapes the pose the rest pose gets stuck in */
+  for (i = 0; i < 4; ++i)
+  {
+    multi[i] = rest[i];
+  }
+
+  assert(cik_fabrik_solve_multistart(multi, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, 8, scratch) == 0);
+  assert(cik_v3_length(cik_v3_sub(multi[3], target)) < 1e-2f);
+
+  for (i = 0; i < 3; ++i)
+  {
+    assert_equalsf(cik_v3_length(cik_v3_sub(multi[i + 1], multi[i])), cik_v3_length(cik_v3_sub(rest[i + 1], rest[i])), 1e-2f);
+  }
+
+  /* Invalid start counts and unreachable target */
+  assert(cik_fabrik_solve_multistart(multi, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, 0, scratch) == 2);
+  assert(cik_fabrik_solve_multistart(multi, 4, target, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, CIK_BATCH_LANES + 1, scratch) == 2);
+  assert(cik_fabrik_solve_multistart(multi, 4, cik_v3(10.0f, 0.0f, 0.0f), max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, 4, scratch) == 3);
+}
+
+void cik_test_fabrik_skip_idle(void)
+{
+#define BATCH_JOINTS 4
+#define BATCH_CHAINS 8
+
+  v3 rest[4] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.3f, 0.0f}, {2.0f, 0.0f, 0.0f}, {3.0f, 0.3f, 0.0f}};
+  v3 positions[4];
+  v3 solved[4];
+  v3 hinge_axes[3] = {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}};
+  int hinge_types[3] = {0, 1, 0};
+  float max_angles[3] = {0.8f, 0.8f, 0.8f};
+  float hinge_min[3] = {-1.5f, -1.5f, -1.5f};
+  float hinge_max[3] = {1.5f, 1.5f, 1.5f};
+  float scratch[CIK_FABRIK_SCRATCH_FLOATS(4)];
+  float batch_scratch[CIK_FABRIK_BATCH_SCRATCH_FLOATS(BATCH_JOINTS) + BATCH_CHAINS];
+  float history[CIK_FABRIK_BATCH_HISTORY_FLOATS * BATCH_CHAINS];
+  float x[BATCH_JOINTS * BATCH_CHAINS], y[BATCH_JOINTS * BATCH_CHAINS], z[BATCH_JOINTS * BATCH_CHAINS];
+  float last_x[BATCH_JOINTS * BATCH_CHAINS];
+  float target_x[BATCH_CHAINS], target_y[BATCH_CHAINS], target_z[BATCH_CHAINS];
+  float importance[BATCH_CHAINS];
+  int results[BATCH_CHAINS], last_results[BATCH_CHAINS];
+  v3 target = cik_v3(2.4f, 0.6f, 0.2f);
+  cik_chain chain;
+  cik_solve_info info;
+  int i, c;
+
+  info.trajectory = 0;
+
+  for (i = 0; i < 4; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  assert(cik_chain_init(&chain, scratch, positions, 4, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max) == 0);
+  chain.flags = CIK_FABRIK_SKIP_IDLE;
+
+  /* Second solve toward the same target is skipped and leaves the pose alone */
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 32, &info) == 0);
+  assert(info.iterations > 0);
+
+  for (i = 0; i < 4; ++i)
+  {
+    solved[i] = positions[i];
+  }
+
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 32, &info) == 0);
+  assert(info.iterations == 0);
+
+  for (i = 0; i < 4; ++i)
+  {
+    assert(positions[i].x == solved[i].x && positions[i].y == solved[i].y && positions[i].z == solved[i].z);
+  }
+
+  /* A looser tolerance is met as well, a tighter one and recompiled constraints solve again */
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-2f, 32, &info) == 0);
+  assert(info.iterations == 0);
+  cik_chain_solve_ex(&chain, positions, target, 1e-5f, 32, &info);
+  assert(info.iterations > 0);
+  assert(chain.last_result == -1 || chain.last_tolerance == 1e-5f);
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 32, &info) == 0);
+  cik_chain_compile(&chain);
+  assert(chain.last_result == -1);
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 32, &info) == 0);
+  assert(info.iterations > 0);
+
+  /* Moved target, unreachable target (settled as well) and a pose reset by the caller */
+  assert(cik_chain_solve_ex(&chain, positions, cik_v3(2.5f, 0.4f, 0.2f), 1e-3f, 32, &info) == 0);
+  assert(info.iterations > 0);
+  assert(cik_chain_solve_ex(&chain, positions, cik_v3(0.0f, 10.0f, 0.0f), 1e-3f, 32, &info) == 3);
+  assert(cik_chain_solve_ex(&chain, positions, cik_v3(0.0f, 10.0f, 0.0f), 1e-3f, 32, &info) == 3);
+  assert(info.iterations == 0);
+
+  for (i = 0; i < 4; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  assert(cik_chain_solve_ex(&chain, positions, cik_v3(0.0f, 10.0f, 0.0f), 1e-3f, 32, &info) == 3);
+  assert(cik_v3_length(cik_v3_sub(positions[3], rest[3])) > 1.0f);
+
+  /* A solve cut short by max_iter is continued, not skipped */
+  for (i = 0; i < 4; ++i)
+  {
+    positions[i] = rest[i];
+  }
+
+  assert(cik_chain_solve_ex(&chain, positions, target, 1e-3f, 1, &info) == 1);
+  cik_chain_solve_ex(&chain, positions, target, 1e-3f, 1, &info);
+  assert(info.iterations == 1);
+
+  /* Batch: idle chains keep pose and result, moved ones are solved again */
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    for (i = 0; i < BATCH_JOINTS; ++i)
+    {
+      x[i * BATCH_CHAINS + c] = rest[i].x;
+      y[i * BATCH_CHAINS + c] = rest[i].y;
+      z[i * BATCH_CHAINS + c] = rest[i].z;
+    }
+
+    target_x[c] = 2.4f + 0.1f * (float)c;
+    target_y[c] = 0.6f - 0.2f * (float)c;
+    target_z[c] = 0.2f;
+    importance[c] = (c == 0) ? 0.2f : 1.0f;
+  }
+
+  cik_fabrik_batch_history_reset(history, BATCH_CHAINS);
+  cik_fabrik_solve_batch_lod(x, y, z, BATCH_JOINTS, BATCH_CHAINS, target_x, target_y, target_z, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, importance, history, results, batch_scratch);
+
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    last_results[c] = results[c];
+    results[c] = -1;
+  }
+
+  for (i = 0; i < BATCH_JOINTS * BATCH_CHAINS; ++i)
+  {
+    last_x[i] = x[i];
+  }
+
+  target_x[1] += 0.05f;
+  importance[0] = 1.0f;
+  cik_fabrik_solve_batch_lod(x, y, z, BATCH_JOINTS, BATCH_CHAINS, target_x, target_y, target_z, max_angles, hinge_types, hinge_axes, hinge_min, hinge_max, 1e-3f, 32, importance, history, results, batch_scratch);
+
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    if (c > 1)
+    {
+      assert(last_results[c] == 1 || results[c] == last_results[c]);
+    }
+
+    for (i = 0; i < BATCH_JOINTS; ++i)
+    {
+      /* Chain 0 rose in tier, chain 1 got a new target */
+      if (c <= 1)
+      {
+        assert(results[c] >= 0);
+      }
+      else if (last_results[c] != 1)
+      {
+        assert(x[i * BATCH_CHAINS + c] == last_x[i * BATCH_CHAINS + c]);
+      }
+    }
+  }
+
+  assert(x[(BATCH_JOINTS - 1) * BATCH_CHAINS + 1] != last_x[(BATCH_JOINTS - 1) * BATCH_CHAINS + 1]);
+
+  /* A tighter tolerance takes the converged chains out of the history again */
+  for (c = 0; c < BATCH_CHAINS; ++c)
+  {
+    assert(results[c] != 0 || cik_fabrik_batch_idle(history, x, y, z, BATCH_JOINTS, BATCH_CHAINS, c, target_x[c], target_y[c], target_z[c], CIK_LOD_TIERS, 1e-3f));
+    assert(!cik_fabrik_batch_idle(history, x, y, z, BATCH_JOINTS, BATCH_CHAINS, c, target_x[c], target_y[c], target_z[c], CIK_LOD_TIERS, 1e-4f) || results[c] != 0);
+  }
+
+#undef BATCH_JOINTS
+#undef BATCH_CHAINS
+}
+
 int main(void)
 {
   cik_test_fabrik_solver_direct();
+  cik_test_fabrik_solve_batch();
+  cik_test_fabrik_solve_batch_lod();
+  cik_test_fabrik_solve_batch_stream();
+#ifdef CIK_THREADS
+  cik_test_fabrik_solve_batch_threaded();
+#endif
+  cik_test_chain_rest_pose();
+  cik_test_solve_two_bone();
+  cik_test_fabrik_solve_planar();
+  cik_test_fabrik_solve_scratch();
+  cik_test_fabrik_solve_ex();
+  cik_test_fabrik_step();
+  cik_test_fabrik_stall();
+  cik_test_fabrik_momentum();
+  cik_test_fabrik_constrain_forward();
+  cik_test_fabrik_specialized();
+  cik_test_fabrik_multistart();
+  cik_test_fabrik_skip_idle();
+  cik_test_fabrik_schedule();
+  cik_test_fabrik_solve_tree();
+  cik_test_ccd_solve();
+  cik_test_dls_solve();
+  cik_test_constraint_tables();
+  cik_test_math_tiers();
 
   return 0;
 }